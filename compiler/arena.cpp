@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <new>
+#include "arena.hpp"
+
+void *Arena::allocate(size_t size, size_t align) {
+    size = (size + align - 1) / align * align;
+    // wyrównanie początku, gdy poprzednio wycięto coś o mniejszym wyrównaniu
+    size_t pad = (align - (uintptr_t)current % align) % align;
+    allocations++;
+    bytes += size;
+    if (pad + size > left) {
+        // duże obiekty dostają własny blok, bieżący blok zostaje
+        if (size > block_size / 4) {
+            char *block = (char*)std::malloc(size);
+            if (!block) {
+                throw std::bad_alloc();
+            }
+            big.push_back(block);
+            return block;
+        }
+        char *block;
+        if (!spare.empty()) {
+            block = spare.back();
+            spare.pop_back();
+        } else {
+            block = (char*)std::malloc(block_size);
+            if (!block) {
+                throw std::bad_alloc();
+            }
+        }
+        blocks.push_back(block);
+        current = block;
+        left = block_size;
+    } else {
+        current += pad;
+        left -= pad;
+    }
+    void *object = current;
+    current += size;
+    left -= size;
+    return object;
+}
+
+void Arena::destroy() {
+    for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+        it->second(it->first);
+    }
+    destructors.clear();
+    for (char *block : big) {
+        std::free(block);
+    }
+    big.clear();
+    current = NULL;
+    left = 0;
+    allocations = 0;
+    bytes = 0;
+}
+
+void Arena::reset() {
+    destroy();
+    spare.insert(spare.end(), blocks.begin(), blocks.end());
+    blocks.clear();
+}
+
+void Arena::release() {
+    destroy();
+    for (char *block : blocks) {
+        std::free(block);
+    }
+    blocks.clear();
+    for (char *block : spare) {
+        std::free(block);
+    }
+    spare.clear();
+}
@@ -0,0 +1,50 @@
+#ifndef ARENA_H
+#define ARENA_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Alokator "bump pointer": obiekty są wycinane kolejno z dużych bloków,
+// a zwalniane wszystkie naraz w release(). Dla typów z nietrywialnym
+// destruktorem (np. std::string w środku) zapamiętujemy go i wołamy przy
+// zwalnianiu. reset() zwalnia obiekty, ale zostawia bloki do ponownego
+// użycia (serwer kompiluje kolejne programy na "ciepłej" arenie).
+class Arena {
+    static const size_t block_size = 64 * 1024;
+    std::vector<char*> blocks;
+    // bloki po reset() czekające na ponowne użycie
+    std::vector<char*> spare;
+    // duże obiekty z własnym blokiem
+    std::vector<char*> big;
+    char *current = NULL;
+    size_t left = 0;
+    std::vector<std::pair<void*, void (*)(void*)>> destructors;
+
+    void destroy();
+    public:
+        int64_t allocations = 0;
+        int64_t bytes = 0;
+
+        Arena() {}
+        Arena(const Arena&) = delete;
+        Arena &operator=(const Arena&) = delete;
+        ~Arena() { release(); }
+
+        void *allocate(size_t size, size_t align = alignof(std::max_align_t));
+        void reset();
+        void release();
+
+        // miejsce na obiekt T (albo klasę pochodną o rozmiarze size)
+        template <class T>
+        void *place(size_t size) {
+            void *object = allocate(size);
+            if (!std::is_trivially_destructible<T>::value) {
+                destructors.push_back(std::make_pair(object, [](void *o) { ((T*)o)->~T(); }));
+            }
+            return object;
+        }
+};
+#endif
@@ -1,27 +1,44 @@
 #include "asm.hpp"
 
-const ASM ASM::GET    = {"GET"};
-const ASM ASM::PUT    = {"PUT"};
+static const char *const names[] = {
+    "GET", "PUT", "LOAD", "STORE", "LOADI", "STOREI",
+    "ADD", "SUB", "SHIFT", "INC", "DEC",
+    "JUMP", "JPOS", "JZERO", "JNEG",
+    "HALT"
+};
 
-const ASM ASM::LOAD   = {"LOAD"};
-const ASM ASM::STORE  = {"STORE"};
-const ASM ASM::LOADI  = {"LOADI"};
-const ASM ASM::STOREI = {"STOREI"};
+const char *asm_name(ASM command) {
+    return names[(uint8_t)command];
+}
 
-const ASM ASM::ADD    = {"ADD"};
-const ASM ASM::SUB    = {"SUB"};
-const ASM ASM::SHIFT  = {"SHIFT"};
-const ASM ASM::INC    = {"INC"};
-const ASM ASM::DEC    = {"DEC"};
+int64_t asm_cost(ASM command) {
+    switch (command) {
+        case ASM::GET: case ASM::PUT:
+            return 100;
+        case ASM::LOAD: case ASM::STORE: case ASM::ADD: case ASM::SUB:
+            return 10;
+        case ASM::LOADI: case ASM::STOREI:
+            return 20;
+        case ASM::SHIFT:
+            return 5;
+        case ASM::HALT:
+            return 0;
+        default:
+            return 1;
+    }
+}
+
+static const char *const constructs[] = {
+    "None", "Assign", "If", "While", "For", "Read", "Write",
+    "Plus", "Minus", "Times", "Div", "Mod", "Condition"
+};
 
-const ASM ASM::JUMP   = {"JUMP"};
-const ASM ASM::JPOS   = {"JPOS"};
-const ASM ASM::JZERO  = {"JZERO"};
-const ASM ASM::JNEG   = {"JNEG"};
-const ASM ASM::HALT   = {"HALT"};
+const char *construct_name(Construct construct) {
+    return constructs[(uint8_t)construct];
+}
 
 std::ostream & operator<<(std::ostream &stream, const Instruction &instruction) {
-    stream << instruction.command.name;
+    stream << asm_name(instruction.command);
     if(instruction.arg != Instruction::Undef) {
         stream << " " << instruction.arg;
     }
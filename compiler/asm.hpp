@@ -1,119 +1,214 @@
 #ifndef ASSEMBLY_H
 #define ASSEMBLY_H 1
 
-#include <string>
+#include <cstdint>
 #include <ostream>
 #include <vector>
 
-struct ASM {
-    std::string name;
-    ASM(std::string name) : name(name) {}
+// Kod operacji to jeden bajt, nazwy są potrzebne tylko przy wypisywaniu
+enum class ASM : uint8_t {
+    GET, PUT, LOAD, STORE, LOADI, STOREI,
+    ADD, SUB, SHIFT, INC, DEC,
+    JUMP, JPOS, JZERO, JNEG,
+    HALT
+};
+
+const char *asm_name(ASM command);
+// cena rozkazu w maszynie z zadania
+int64_t asm_cost(ASM command);
 
-    static const ASM GET, PUT, LOAD, STORE, LOADI, STOREI,
-                    ADD, SUB, SHIFT, INC, DEC,  
-                    JUMP, JPOS, JZERO, JNEG,
-                    HALT;      
+// Rodzaj konstrukcji źródła, z której pochodzi rozkaz (dla profilera):
+// instrukcja programu albo wyrażenie / warunek wewnątrz niej
+enum class Construct : uint8_t {
+    None, Assign, If, While, For, Read, Write,
+    Plus, Minus, Times, Div, Mod, Condition
 };
 
+const char *construct_name(Construct construct);
+
+// Instrukcja programu w mapie linii: linia, rodzaj i linia instrukcji
+// złożonej, w której leży (0 na najwyższym poziomie), a dla pętli FOR
+// o stałych granicach liczba obrotów (-1 gdy nieznana)
+struct Site {
+    int32_t line;
+    Construct construct;
+    int32_t parent;
+    int64_t trips;
+};
+
+struct Instruction;
+
+// Skok dopisany zanim znany jest jego cel. Trzyma indeks, a nie wskaźnik,
+// bo wektor rozkazów może się przenieść przy powiększaniu.
+class Pending {
+    std::vector<Instruction> *code;
+    size_t index;
+    public:
+        Pending() : code(NULL), index(0) {}
+        Pending(std::vector<Instruction> *code, size_t index) : code(code), index(index) {}
+        inline Instruction *operator->();
+};
+
+// Strumień wyjściowy generatora: węzły AST dopisują rozkazy na koniec jednego
+// wektora zamiast zwracać własne kopie. label to adres następnego rozkazu,
+// line i construct to linia i rodzaj konstrukcji, z której pochodzą
+// dopisywane rozkazy, sites to kolejne instrukcje programu z zagnieżdżeniem.
+class Emitter {
+    public:
+        std::vector<Instruction> code;
+        std::vector<Site> sites;
+        int64_t label;
+        int32_t line = 0;
+        Construct construct = Construct::None;
+        Emitter(int64_t label = 0) : label(label) {}
+        inline Pending push(ASM command, int64_t arg);
+};
+
+// linia źródła i rodzaj konstrukcji na czas generowania jednej instrukcji
+// programu albo wyrażenia w niej (wtedy linia się nie zmienia)
+class LineScope {
+    Emitter &out;
+    int32_t saved_line;
+    Construct saved_construct;
+    public:
+        LineScope(Emitter &out, int64_t line, Construct construct)
+        : out(out), saved_line(out.line), saved_construct(out.construct) {
+            out.line = line;
+            out.construct = construct;
+        }
+        LineScope(Emitter &out, Construct construct) : LineScope(out, out.line, construct) {}
+        ~LineScope() {
+            out.line = saved_line;
+            out.construct = saved_construct;
+        }
+};
+
+// Rozkaz trzymany przez wartość w ciągłej tablicy (16 bajtów). Adres rozkazu
+// to jego indeks, więc osobna etykieta nie jest potrzebna. Rodzaj konstrukcji
+// i linia źródła (0 gdy nieznana) mieszczą się w wyrównaniu między kodem
+// a argumentem.
 struct Instruction {
-    private:
-        Instruction(ASM command, int64_t label)
-            : command(command), label(label) {}
-        Instruction(ASM command, int64_t arg, int64_t label)
-            : command(command), arg(arg), label(label) {}
     public:
         static const int64_t Undef = -1;
 
         ASM command;
-        int64_t arg = Undef, label;
+        Construct construct = Construct::None;
+        int32_t line = 0;
+        int64_t arg = Undef;
+
+        Instruction(ASM command, int64_t arg = Undef) : command(command), arg(arg) {}
+        Instruction(ASM command, int64_t arg, int32_t line, Construct construct)
+        : command(command), construct(construct), line(line), arg(arg) {}
+
+        bool is_jump() const {
+            return command == ASM::JUMP || command == ASM::JPOS
+                || command == ASM::JZERO || command == ASM::JNEG;
+        }
+        // argument to adres komórki pamięci
+        bool is_memory() const {
+            return command == ASM::LOAD || command == ASM::STORE || command == ASM::LOADI
+                || command == ASM::STOREI || command == ASM::ADD || command == ASM::SUB
+                || command == ASM::SHIFT;
+        }
 
 
         // jumpy które potem będą miały dodane miejsca skoków
 
-        static Instruction *JUMP(int64_t arg,int64_t *label) {
-            return new Instruction(ASM::JUMP, (*label)++);
+        static Pending JUMP(Emitter &out) {
+            return out.push(ASM::JUMP, Undef);
         }
 
-        static Instruction *JPOS(int64_t arg,int64_t *label) {
-            return new Instruction(ASM::JPOS, (*label)++);
+        static Pending JPOS(Emitter &out) {
+            return out.push(ASM::JPOS, Undef);
         }
 
-        static Instruction *JZERO(int64_t arg,int64_t *label) {
-            return new Instruction(ASM::JZERO, (*label)++);
+        static Pending JZERO(Emitter &out) {
+            return out.push(ASM::JZERO, Undef);
         }
 
-        static Instruction *JNEG(int64_t arg,int64_t *label) {
-            return new Instruction(ASM::JNEG, (*label)++);
+        static Pending JNEG(Emitter &out) {
+            return out.push(ASM::JNEG, Undef);
         }
 
 
         // gotowe komendy
 
-        static void GET(std::vector<Instruction*>& out, int64_t* label) {
-                out.push_back(new Instruction(ASM::GET, (*label)++));
+        static void GET(Emitter &out) {
+                out.push(ASM::GET, Undef);
         }
 
-        static void PUT(std::vector<Instruction*>& out, int64_t* label) {
-                out.push_back(new Instruction(ASM::PUT, (*label)++));
+        static void PUT(Emitter &out) {
+                out.push(ASM::PUT, Undef);
         }
 
-        static void LOAD(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::LOAD, arg, (*label)++));
+        static void LOAD(Emitter &out, int64_t arg) {
+                out.push(ASM::LOAD, arg);
         }
 
-        static void STORE(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::STORE, arg, (*label)++));
+        static void STORE(Emitter &out, int64_t arg) {
+                out.push(ASM::STORE, arg);
         }
 
-        static void LOADI(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::LOADI, arg, (*label)++));
+        static void LOADI(Emitter &out, int64_t arg) {
+                out.push(ASM::LOADI, arg);
         }
 
-        static void STOREI(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::STOREI, arg, (*label)++));
+        static void STOREI(Emitter &out, int64_t arg) {
+                out.push(ASM::STOREI, arg);
         }
 
-        static void ADD(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::ADD, arg, (*label)++));
+        static void ADD(Emitter &out, int64_t arg) {
+                out.push(ASM::ADD, arg);
         }
 
-        static void SUB(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::SUB, arg, (*label)++));
+        static void SUB(Emitter &out, int64_t arg) {
+                out.push(ASM::SUB, arg);
         }
 
-        static void SHIFT(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::SHIFT, arg, (*label)++));
+        static void SHIFT(Emitter &out, int64_t arg) {
+                out.push(ASM::SHIFT, arg);
         }
 
-        static void INC(std::vector<Instruction*>& out, int64_t* label) {
-                out.push_back(new Instruction(ASM::INC, (*label)++));
+        static void INC(Emitter &out) {
+                out.push(ASM::INC, Undef);
         }
 
-        static void DEC(std::vector<Instruction*>& out, int64_t* label) {
-                out.push_back(new Instruction(ASM::DEC, (*label)++));   
+        static void DEC(Emitter &out) {
+                out.push(ASM::DEC, Undef);
         }
 
-        static void HALT(std::vector<Instruction*>& out, int64_t* label) {
-                out.push_back(new Instruction(ASM::HALT, (*label)++));   
+        static void HALT(Emitter &out) {
+                out.push(ASM::HALT, Undef);
         }
 
-        static void JUMP(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::JUMP, arg, (*label)++));  
-
+        static void JUMP(Emitter &out, int64_t arg) {
+                out.push(ASM::JUMP, arg);
         }
-        static void JPOS(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::JPOS, arg, (*label)++));  
+        static void JPOS(Emitter &out, int64_t arg) {
+                out.push(ASM::JPOS, arg);
         }
-        static void JZERO(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::JZERO, arg, (*label)++));  
+        static void JZERO(Emitter &out, int64_t arg) {
+                out.push(ASM::JZERO, arg);
         }
-        static void JNEG(std::vector<Instruction*>& out, int64_t arg, int64_t* label) {
-                out.push_back(new Instruction(ASM::JNEG, arg, (*label)++));  
+        static void JNEG(Emitter &out, int64_t arg) {
+                out.push(ASM::JNEG, arg);
         }
 
 
 };
 
+Instruction *Pending::operator->() {
+    return &(*code)[index];
+}
+
+static_assert(sizeof(Instruction) == 16, "Instruction should stay 16 bytes");
+
+Pending Emitter::push(ASM command, int64_t arg) {
+    code.push_back(Instruction(command, arg, line, construct));
+    label++;
+    return Pending(&code, code.size() - 1);
+}
+
 std::ostream & operator<<(std::ostream &stream, const Instruction &instruction);
 
 #endif
\ No newline at end of file
@@ -2,24 +2,24 @@
 #include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <typeinfo>
 #include "ast.hpp"
 #include "symbols.hpp"
 #include "code_gen.hpp"
 #include "asm.hpp"
+#include "eval.hpp"
+#include "context.hpp"
 
 
 
-extern Symbols symbols;
-extern CodeGen generator;
 
 namespace ast {
 
-    std::vector<Instruction*> generate_number(int64_t number, int64_t *label) {
-        std::vector<Instruction*> output;
-        Instruction::SUB(output, 0, label);
+    void generate_number(Context &ctx, int64_t number, Emitter &out) {
+        Instruction::SUB(out, 0);
         if (number == 0) {
-            return output;
+            return;
         }
         bool sign = (number > 0) ? true : false;
         std::vector<char> helper;
@@ -38,88 +38,158 @@ namespace ast {
         }
          // Mnożenie przez potęgi (trzebaby zoptymalizować)
         reverse(begin(helper), end(helper));
-        Instruction::INC(output, label);
-        Instruction::STORE(output,symbols.offset,label);
-         Instruction::DEC(output, label);
-        int64_t one_mem_pos = symbols.offset;
-        symbols.offset++;
+        Instruction::INC(out);
+        Instruction::STORE(out, ctx.symbols.offset);
+         Instruction::DEC(out);
+        int64_t one_mem_pos = ctx.symbols.offset;
+        ctx.symbols.offset++;
 
         for (char c: helper) {
             if (c == 's') {
-                Instruction::SHIFT(output, one_mem_pos, label);
+                Instruction::SHIFT(out, one_mem_pos);
             } else if (c == 'i') {
                 if (!sign){
-                    Instruction::DEC(output, label);
+                    Instruction::DEC(out);
                 } else {
-                    Instruction::INC(output, label);
+                    Instruction::INC(out);
                 }
             } else {
-                std::cerr << "weird" << std::endl;
-                exit(EXIT_FAILURE);
+                throw std::logic_error("weird");
             }
         }
-        return output;
     }
     
-    void insert_back(std::vector<Instruction*>& target, std::vector<Instruction*>& stuff) {
-        target.insert(target.end(), stuff.begin(), stuff.end());
-    }
-
-    void insert_back(std::vector<Instruction*>& target, const std::vector<Instruction*>& stuff) {
-        target.insert(target.end(), stuff.begin(), stuff.end());
-    }
 
-
-    bool check_init(Identifier *identifier) {
+    bool check_init(Context &ctx, Identifier *identifier) {
 
         if (identifier->type() == 2){
-            if (!symbols.is_initialized(((ast::VarArray*)identifier)->index)) {
+            if (!ctx.symbols.is_initialized(((ast::VarArray*)identifier)->index)) {
                 std::ostringstream os;
                 os << "Attempt to write unintialized variable: " << ((ast::VarArray*)identifier)->index->name << std::endl;
-                generator.report(os, identifier->line);
+                ctx.generator.report(os, identifier->line);
                 return false;
             }
         }
 
-        if (!symbols.is_initialized(identifier)) {
+        if (!ctx.symbols.is_initialized(identifier)) {
             std::ostringstream os;
             os << "Attempt to write unintialized variable: " << identifier->name << std::endl;
-            generator.report(os, identifier->line);
+            ctx.generator.report(os, identifier->line);
             return false;
         }
         return true;
     }
-    bool check_init(Value *value) {
+    bool check_init(Context &ctx, Value *value) {
         if (value->is_const()) {
             return true;
         }
-        return check_init(value->identifier);
+        return check_init(ctx, value->identifier);
+    }
+
+
+    void load_value(Context &ctx, Value *value, Emitter &out) {
+        value->gen_ir(ctx, out);
+    }
+
+    // zwykła zmienna może być od razu argumentem ADD/SUB, bez komórki pomocniczej
+    bool direct_cell(Context &ctx, Value *value, int64_t &cell) {
+        if (value->is_const() || value->identifier->type() != 0) {
+            return false;
+        }
+        Symbol &var = ctx.symbols.get_symbol(value->identifier);
+        if (var.line == Symbol::undef || var.is_array || var.offset_id == Symbol::undef) {
+            return false;
+        }
+        cell = var.offset_id;
+        return true;
+    }
+
+    // operand w uwagach -Rpass tak jak w źródle
+    std::string operand(Value *value) {
+        if (value->is_const()) {
+            return std::to_string(value->value);
+        }
+        Identifier *identifier = value->identifier;
+        if (identifier->type() == 1) {
+            return std::string(identifier->name) + "(" + std::to_string(((ConstArray*)identifier)->idx) + ")";
+        } else if (identifier->type() == 2) {
+            return std::string(identifier->name) + "(" + ((VarArray*)identifier)->index->name + ")";
+        }
+        return identifier->name;
     }
 
+    // statyczny koszt rozkazów od adresu from
+    int64_t static_cost(const std::vector<Instruction> &code, size_t from) {
+        int64_t cost = 0;
+        for (size_t i = from; i < code.size(); i++) {
+            cost += asm_cost(code[i].command);
+        }
+        return cost;
+    }
 
-    std::vector<Instruction*> load_value(Value *value, int64_t *label) {    
-        return value->gen_ir(label);
+    void folded(Context &ctx, Emitter &out, Value *left, const char *op, Value *right, int64_t result) {
+        if (ctx.generator.remarks.enabled()) {
+            ctx.generator.remarks.passed("constant-fold", out.line,
+                operand(left) + " " + op + " " + operand(right) + " folded to " + std::to_string(result));
+        }
     }
 
-    void err_redeclaration(Identifier *identifier) {
+    // dzielenie przez stałą nie ma osobnej ścieżki, zawsze jest pętla ogólna
+    void divided(Context &ctx, Emitter &out, Value *left, const char *op, Value *right, size_t begin) {
+        if (!ctx.generator.remarks.enabled()) {
+            return;
+        }
+        std::string expression = operand(left) + " " + op + " " + operand(right);
+        ctx.generator.remarks.missed("strength-reduction", out.line, right->is_const()
+            ? "divisor " + operand(right) + " is constant but " + expression + " uses the generic division loop"
+            : "no constant divisor in " + expression + ", generic division loop used",
+            out.code.size() - begin, static_cost(out.code, begin));
+    }
+
+    // operand bez własnej komórki idzie przez komórkę pomocniczą (jeden STORE)
+    void spilled(Context &ctx, Emitter &out, Value *value) {
+        if (ctx.generator.remarks.enabled()) {
+            ctx.generator.remarks.missed("direct-operand", out.line, value->is_const()
+                ? "constant " + operand(value) + " has no memory cell and is stored in a temporary"
+                : "operand " + operand(value) + " is not a simple variable and is stored in a temporary",
+                1, asm_cost(ASM::STORE));
+        }
+    }
+
+    void err_redeclaration(Context &ctx, Identifier *identifier) {
         std::ostringstream os;
          os  <<  "Duplicate declaration of " << identifier->name
             << ": first declared in line "
-            << symbols.get_symbol(identifier->name).line;
-        generator.report(os, identifier->line);
+            << ctx.symbols.get_symbol(identifier).line;
+        ctx.generator.report(os, identifier->line);
     }
 
-    std::vector <Instruction*> Program::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> out;
+    void Program::gen_ir(Context &ctx, Emitter &out) {
+        PhaseScope phase(ctx.timing, Phase::Codegen);
+        // bez przebiegu liveness wszystkie deklaracje dostają pamięć
+        if (declarations) {
+            declarations->used.clear();
+            for (Identifier *identifier : declarations->identifiers) {
+                declarations->used.insert(identifier->name);
+            }
+        }
+        if (declarations) {
+            declarations->bind(ctx.symbols);
+        }
+        code->bind(ctx.symbols);
+        // przebiegi na AST (passes.cpp): wspólne podwyrażenia, potem martwe
+        // przypisania i nieużywane zmienne; oba pracują na numerach symboli
+        ctx.passes.run(Stage::Program, this, NULL);
+
         if (declarations) {
-            out = declarations->gen_ir(cur_label);
+            PhaseScope phase(ctx.timing, Phase::Declarations);
+            declarations->gen_ir(ctx, out);
         }
-        insert_back(out, code->gen_ir(cur_label));
-        Instruction::HALT(out, cur_label);
-        return out;
+        code->gen_ir(ctx, out);
+        Instruction::HALT(out);
     }
 
-    std::vector <Instruction*> Declarations::gen_ir(int64_t *cur_label) {
+    void Declarations::gen_ir(Context &ctx, Emitter &out) {
         
 
         std::vector<Identifier*> vars;
@@ -137,436 +207,507 @@ namespace ast {
         }
 
         for (Identifier *identifier : vars) {
-            if (!symbols.declare(identifier)) {
-                err_redeclaration(identifier);
+            if (!ctx.symbols.declare(identifier, used.count(identifier->name))) {
+                err_redeclaration(ctx, identifier);
             }
         }
-        symbols.alloc_for_control(for_counter);
+        ctx.symbols.alloc_for_control(for_counter);
 
-        std::vector<Instruction*> out;
         for (Identifier *identifier : arrays) {
-            if (!symbols.declare(identifier)) {
-                err_redeclaration(identifier);
+            bool reserve = used.count(identifier->name);
+            if (!ctx.symbols.declare(identifier, reserve)) {
+                err_redeclaration(ctx, identifier);
             }
             if (((ast::ConstArray*)identifier)->index_b > ((ast::ConstArray*)identifier)->index_e) {
                 std::ostringstream os;
                 os << "Wrong range of table: " << identifier->name << std::endl;
-                generator.report(os, identifier->line);
+                ctx.generator.report(os, identifier->line);
+            }
+            ctx.symbols.set_array(identifier);
+            if (!reserve) {
+                // nieużywana tablica: bez pamięci i bez nagłówka
+                Emitter scratch(out.label);
+                int64_t offset = ctx.symbols.offset;
+                generate_number(ctx, offset, scratch);
+                generate_number(ctx, ((ast::ConstArray*)identifier)->index_b, scratch);
+                ctx.generator.eliminated(scratch.code.size() + 2);
+                if (ctx.generator.remarks.enabled()) {
+                    ctx.generator.remarks.passed("unused-array", identifier->line,
+                        std::string("array ") + identifier->name + " is never read, no memory or header",
+                        scratch.code.size() + 2, static_cost(scratch.code, 0) + 2 * asm_cost(ASM::STORE));
+                }
+                ctx.symbols.offset = offset;
+                continue;
             }
-            symbols.set_array(identifier);
             // Array ma n+2 zarezerwowanych komórek pamięci, gdzie n to deklarowany size
             // W zerowym miejscu arraya znajduje sie jego offset
-            insert_back(out, generate_number(symbols.get_symbol(identifier->name).offset_id, cur_label));
-            Instruction::STORE(out, symbols.get_symbol(identifier->name).offset_id, cur_label);
+            generate_number(ctx, ctx.symbols.get_symbol(identifier).offset_id, out);
+            Instruction::STORE(out, ctx.symbols.get_symbol(identifier).offset_id);
             // na kolejnym miejscu znajduje się index od którego zaczynamy liczyć
-            insert_back(out, generate_number(symbols.get_symbol(identifier->name).idx_b, cur_label));
-            Instruction::STORE(out, symbols.get_symbol(identifier->name).offset_id+1, cur_label);
+            generate_number(ctx, ctx.symbols.get_symbol(identifier).idx_b, out);
+            Instruction::STORE(out, ctx.symbols.get_symbol(identifier).offset_id+1);
         }
-        return out;
     }
 
     void Declarations::declare(Identifier *identifier){
         identifiers.push_back(identifier);
     }
 
-    std::vector<Instruction*> Commands::gen_ir(int64_t *cur_label) {
+    void Commands::gen_ir(Context &ctx, Emitter &out) {
 
-        std::vector<Instruction*> output;
         for (Command *cmd : commands) {
-            std::vector<Instruction*> cmd_out = cmd->gen_ir(cur_label);
-            output.insert(output.end(), cmd_out.begin(), cmd_out.end());
+            // rodzicem jest instrukcja złożona, której ciało teraz generujemy
+            out.sites.push_back(Site{(int32_t)cmd->line, cmd->construct(), out.line, cmd->trips()});
+            LineScope scope(out, cmd->line, cmd->construct());
+            cmd->gen_ir(ctx, out);
         }
-        return output;
     }
 
     void Commands::add_command(Command *cmd) {
         commands.push_back(cmd);
     }
 
-    std::vector<Instruction*> Value::gen_ir(int64_t *cur_label){
-        std::vector<Instruction*> output;
+    void Value::gen_ir(Context &ctx, Emitter &out){
         if (is_const()) {
-            output = generate_number(value, cur_label);
+            generate_number(ctx, value, out);
         } else {
-            output = identifier->gen_ir(cur_label);
+            identifier->gen_ir(ctx, out);
         }
-        return output;
     }
 
-    std::vector<Instruction*> Assign::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> output;
-        if (!symbols.set_initialized(identifier)) {
+    void Assign::gen_ir(Context &ctx, Emitter &out) {
+        if (!dead) {
+            emit(ctx, out);
+            return;
+        }
+        // martwy zapis: generujemy na brudno tylko dla diagnostyki i inicjalizacji
+        Emitter scratch(out.label);
+        int64_t offset = ctx.symbols.offset;
+        {
+            Remarks::Mute mute(ctx.generator.remarks);
+            emit(ctx, scratch);
+        }
+        ctx.generator.eliminated(scratch.code.size());
+        if (ctx.generator.remarks.enabled()) {
+            ctx.generator.remarks.passed("dead-store", line, std::string("value assigned to ") + identifier->name + " is never read",
+                scratch.code.size(), static_cost(scratch.code, 0));
+        }
+        ctx.symbols.offset = offset;
+    }
+
+    void Assign::emit(Context &ctx, Emitter &out) {
+        if (!ctx.symbols.set_initialized(identifier)) {
               std::ostringstream os;
             os << "not defined: " << identifier->name;
-            generator.report(os, line);
-            return output;
+            ctx.generator.report(os, line);
+            return;
         }
-        if (symbols.is_iterator(identifier)) {
+        if (ctx.symbols.is_iterator(identifier)) {
             std::ostringstream os;
             os << "Attempt to modify the iterator in a FOR loop: " << identifier->name;
-            generator.report(os, line);
-            return output;
+            ctx.generator.report(os, line);
+            return;
         }
-        std::string name = identifier->name;
+        const char *name = identifier->name;
+        // kopia: generacja wyrażenia może wiązać nowe symbole
+        Symbol var = ctx.symbols.get_symbol(identifier);
         if (identifier->type() == 1) {
             
-            if (!symbols.get_symbol(name).is_array) {
+            if (!var.is_array) {
                 std::ostringstream os;
                 os << "Attempt to use a simple variable " << name << " as an array";
-                generator.report(os, line);
+                ctx.generator.report(os, line);
             }
 
             // załaduj wartość
-            insert_back(output, expression->gen_ir(cur_label));
+            {
+                LineScope scope(out, expression->construct());
+                expression->gen_ir(ctx, out);
+            }
             // oblić dobre miejsce w pamięci i wrzuć wartość tam
-            int64_t off = symbols.get_symbol(name).offset_id;
-            auto idx = (((ast::ConstArray*)identifier)->idx+2 - symbols.get_symbol(name).idx_b); 
-            Instruction::STORE(output,off+idx, cur_label);
+            int64_t off = var.offset_id;
+            auto idx = (((ast::ConstArray*)identifier)->idx+2 - var.idx_b); 
+            Instruction::STORE(out, off+idx);
         } else if (identifier->type() == 2) {
 
-            if (!symbols.get_symbol(name).is_array) {
+            if (!var.is_array) {
                 std::ostringstream os;
                 os << "Attempt to use a simple variable " << name << " as an array";
-                generator.report(os, line);
+                ctx.generator.report(os, line);
             }
 
             // load size
-            Instruction::LOAD(output, symbols.get_symbol(name).offset_id, cur_label);
+            Instruction::LOAD(out, var.offset_id);
             // odejmij index startowy od size'a
-            Instruction::SUB(output,  symbols.get_symbol(name).offset_id+1, cur_label);
+            Instruction::SUB(out, var.offset_id+1);
             // dodaj 2 bo prawidziwy size = n+2
-            Instruction::INC(output, cur_label);
-            Instruction::INC(output, cur_label);
+            Instruction::INC(out);
+            Instruction::INC(out);
             //dodaj szukany index, przechowaj wszystko w tempie
-            Instruction::ADD(output, symbols.get_symbol(((ast::VarArray*)identifier)->index->name).offset_id, cur_label);
-            int64_t temp = symbols.offset; symbols.offset++;
-            Instruction::STORE(output, temp, cur_label);
+            Instruction::ADD(out, ctx.symbols.get_symbol(((ast::VarArray*)identifier)->index).offset_id);
+            int64_t temp = ctx.symbols.offset; ctx.symbols.offset++;
+            Instruction::STORE(out, temp);
             // pobierz wartość i przechowaj ją w komórce pamięci obliczonej wcześniej
-            insert_back(output, expression->gen_ir(cur_label));
-            Instruction::STOREI(output, temp, cur_label);                
+            {
+                LineScope scope(out, expression->construct());
+                expression->gen_ir(ctx, out);
+            }
+            Instruction::STOREI(out, temp);                
         } else {
             // załaduj wartość
-            insert_back(output, expression->gen_ir(cur_label));
-            Instruction::STORE(output, symbols.get_symbol(name).offset_id, cur_label);
+            {
+                LineScope scope(out, expression->construct());
+                expression->gen_ir(ctx, out);
+            }
+            Instruction::STORE(out, var.offset_id);
 
         }
-        
-        return output;
     }
 
-    std::vector<Instruction*> If::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> out = condition->gen_ir(cur_label);
-        Instruction *jump_else = Instruction::JZERO(Instruction::Undef, cur_label);
-        out.push_back(jump_else);
+    void If::gen_ir(Context &ctx, Emitter &out) {
+        {
+            LineScope scope(out, Construct::Condition);
+            condition->gen_ir(ctx, out);
+        }
+        Pending jump_else = Instruction::JZERO(out);
     
-        auto branch_then = do_then->gen_ir(cur_label);
-        out.insert(out.end(), branch_then.begin(), branch_then.end());
+        do_then->gen_ir(ctx, out);
         
         if(do_else) {
-            Instruction *jump_end = Instruction::JUMP(Instruction::Undef, cur_label);
-            out.push_back(jump_end);
-            auto branch_else = do_else->gen_ir(cur_label);
-            out.insert(out.end(), branch_else.begin(), branch_else.end());
-            jump_else->arg = branch_else[0]->label;
-            jump_end->arg = *cur_label;
+            Pending jump_end = Instruction::JUMP(out);
+            // gałąź może być pusta (np. same martwe przypisania)
+            jump_else->arg = out.label;
+            do_else->gen_ir(ctx, out);
+            jump_end->arg = out.label;
         } else {
-            jump_else->arg = *cur_label;
+            jump_else->arg = out.label;
         }
-
-        return out;
     }
     // Pretty much done
-    std::vector<Instruction*> While::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> out;
+    void While::gen_ir(Context &ctx, Emitter &out) {
         if (!reversed) {
-            out = condition->gen_ir(cur_label);
-            int64_t lbl = out[0]->label;
-            Instruction *jump_end = Instruction::JZERO(Instruction::Undef, cur_label);
-            out.push_back(jump_end);
-            auto loop_body = body->gen_ir(cur_label);
-            out.insert(out.end(), loop_body.begin(), loop_body.end());
-            Instruction::JUMP(out, lbl, cur_label);
-            jump_end->arg = *cur_label;
+            int64_t lbl = out.label;
+            {
+                LineScope scope(out, Construct::Condition);
+                condition->gen_ir(ctx, out);
+            }
+            Pending jump_end = Instruction::JZERO(out);
+            body->gen_ir(ctx, out);
+            Instruction::JUMP(out, lbl);
+            jump_end->arg = out.label;
             
         } else {
-            out = body->gen_ir(cur_label);
-            int64_t lbl = out[0]->label;
-            insert_back(out,condition->gen_ir(cur_label));
-            Instruction::JZERO(out,lbl, cur_label);
+            int64_t lbl = out.label;
+            body->gen_ir(ctx, out);
+            {
+                LineScope scope(out, Construct::Condition);
+                condition->gen_ir(ctx, out);
+            }
+            Instruction::JZERO(out, lbl);
         }
-       return out;
     }
 
-    std::vector<Instruction*> For::gen_ir(int64_t *cur_label) {
-         std::vector<Instruction*> out;
-         if (!symbols.declare_iterator(iterator)){
+    void For::gen_ir(Context &ctx, Emitter &out) {
+         if (!ctx.symbols.declare_iterator(iterator)){
                std::ostringstream os;
             os  << "Duplicate declaration of " << iterator->name
                 << ": first declared in line "
-                << symbols.get_symbol(iterator->name).line;
-            generator.report(os, iterator->line);
-            return out;
+                << ctx.symbols.get_symbol(iterator).line;
+            ctx.generator.report(os, iterator->line);
+            return;
          }   
-        if (! (check_init(from) && check_init(to))) {
-            return out;
+        if (! (check_init(ctx, from) && check_init(ctx, to))) {
+            return;
         }
 
-        symbols.set_initialized(iterator);
-        symbols.set_iterator(iterator);
+        ctx.symbols.set_initialized(iterator);
+        ctx.symbols.set_iterator(iterator);
 
         if (from->is_const()) {
-            insert_back(out, generate_number(from->value, cur_label));
+            generate_number(ctx, from->value, out);
         } else {
-            insert_back(out, load_value(from, cur_label));
+            load_value(ctx, from, out);
         }
-        Instruction::STORE(out, symbols.get_symbol(iterator->name).offset_id, cur_label);
+        Instruction::STORE(out, ctx.symbols.get_symbol(iterator).offset_id);
         Symbol to_var;
 
-        Identifier *_to = new Var("_TO_" + std::to_string(id), Identifier::N, line);
-        if (!symbols.declare_iterator(_to)) {
-            std::cerr << "CANNOT DECLARE _TO: LINE "<< line << std::endl;
-            exit(EXIT_FAILURE);
+        // bind() powiększa tablicę symboli: od tego miejsca (i po ciele pętli
+        // z zagnieżdżonymi FOR) symbole są kopiowane albo szukane od nowa
+        Identifier *_to = new (ctx) Var(ctx.names.intern("_TO_" + std::to_string(id)), Identifier::N, line);
+        ctx.symbols.bind(_to);
+        if (!ctx.symbols.declare_iterator(_to)) {
+            throw std::logic_error("CANNOT DECLARE _TO: LINE " + std::to_string(line));
         }
-        to_var = symbols.get_symbol(_to->name);
+        to_var = ctx.symbols.get_symbol(_to);
 
         if (to->is_const()) {
-            insert_back(out, generate_number(to->value, cur_label));
+            generate_number(ctx, to->value, out);
         } else {
-            insert_back(out, load_value(to, cur_label));
+            load_value(ctx, to, out);
         }
-         Instruction::STORE(out, to_var.offset_id, cur_label);
+         Instruction::STORE(out, to_var.offset_id);
         
-        int64_t iteracje = symbols.offset; symbols.offset++;
+        int64_t iteracje = ctx.symbols.offset; ctx.symbols.offset++;
 
         if (reversed) {
-            Instruction::LOAD(out, symbols.get_symbol(iterator->name).offset_id, cur_label);
-            Instruction::SUB(out, to_var.offset_id, cur_label);
-            Instruction::INC(out, cur_label);
-            Instruction::STORE(out, iteracje, cur_label);
-
-            Instruction::JNEG(out, *cur_label+5, cur_label);
-            int64_t start = *cur_label;
-            Instruction::JZERO(out, *cur_label+4, cur_label);
-            Instruction::DEC(out, cur_label);
-            Instruction::STORE(out, iteracje, cur_label);
-
-            Instruction::JUMP(out, *cur_label+2, cur_label);
-            Instruction *jump_end = Instruction::JUMP(Instruction::Undef, cur_label);
-            out.push_back(jump_end);
-
-            insert_back(out, body->gen_ir(cur_label));
-
-            Instruction::LOAD(out, symbols.get_symbol(iterator->name).offset_id, cur_label);
-            Instruction::DEC(out, cur_label);
-            Instruction::STORE(out, symbols.get_symbol(iterator->name).offset_id, cur_label);
-            Instruction::LOAD(out, iteracje, cur_label);
-            Instruction::JUMP(out, start, cur_label);
-
-            jump_end->arg = *cur_label;
+            Instruction::LOAD(out, ctx.symbols.get_symbol(iterator).offset_id);
+            Instruction::SUB(out, to_var.offset_id);
+            Instruction::INC(out);
+            Instruction::STORE(out, iteracje);
+
+            Instruction::JNEG(out, out.label+5);
+            int64_t start = out.label;
+            Instruction::JZERO(out, out.label+4);
+            Instruction::DEC(out);
+            Instruction::STORE(out, iteracje);
+
+            Instruction::JUMP(out, out.label+2);
+            Pending jump_end = Instruction::JUMP(out);
+
+            body->gen_ir(ctx, out);
+
+            Instruction::LOAD(out, ctx.symbols.get_symbol(iterator).offset_id);
+            Instruction::DEC(out);
+            Instruction::STORE(out, ctx.symbols.get_symbol(iterator).offset_id);
+            Instruction::LOAD(out, iteracje);
+            Instruction::JUMP(out, start);
+
+            jump_end->arg = out.label;
         } else {
-            Instruction::LOAD(out, to_var.offset_id, cur_label);
-            Instruction::SUB(out, symbols.get_symbol(iterator->name).offset_id, cur_label);
-            Instruction::INC(out, cur_label);
-            Instruction::STORE(out, iteracje, cur_label);
-
-            Instruction::JNEG(out, *cur_label+5, cur_label);
-            int64_t start = *cur_label;
-            Instruction::JZERO(out, *cur_label+4, cur_label);
-            Instruction::DEC(out, cur_label);
-            Instruction::STORE(out, iteracje, cur_label);
-
-            Instruction::JUMP(out, *cur_label+2, cur_label);
-            Instruction *jump_end = Instruction::JUMP(Instruction::Undef, cur_label);
-            out.push_back(jump_end);
-
-            insert_back(out, body->gen_ir(cur_label));
-
-            Instruction::LOAD(out, symbols.get_symbol(iterator->name).offset_id, cur_label);
-            Instruction::INC(out, cur_label);
-            Instruction::STORE(out, symbols.get_symbol(iterator->name).offset_id, cur_label);
-            Instruction::LOAD(out, iteracje, cur_label);
-            Instruction::JUMP(out, start, cur_label);
-
-            jump_end->arg = *cur_label;
+            Instruction::LOAD(out, to_var.offset_id);
+            Instruction::SUB(out, ctx.symbols.get_symbol(iterator).offset_id);
+            Instruction::INC(out);
+            Instruction::STORE(out, iteracje);
+
+            Instruction::JNEG(out, out.label+5);
+            int64_t start = out.label;
+            Instruction::JZERO(out, out.label+4);
+            Instruction::DEC(out);
+            Instruction::STORE(out, iteracje);
+
+            Instruction::JUMP(out, out.label+2);
+            Pending jump_end = Instruction::JUMP(out);
+
+            body->gen_ir(ctx, out);
+
+            Instruction::LOAD(out, ctx.symbols.get_symbol(iterator).offset_id);
+            Instruction::INC(out);
+            Instruction::STORE(out, ctx.symbols.get_symbol(iterator).offset_id);
+            Instruction::LOAD(out, iteracje);
+            Instruction::JUMP(out, start);
+
+            jump_end->arg = out.label;
         }
 
-        symbols.undeclare_iter(_to->name);
+        ctx.symbols.undeclare_iter(_to);
         //std::cerr << "undeclaring " << _to->name << std::endl; 
-        symbols.undeclare_iter(iterator->name);
+        ctx.symbols.undeclare_iter(iterator);
         //std::cerr << "undeclaring " << iterator->name << std::endl;
-        
-        return out;
+    }
+
+    // stałe granice, obie włącznie
+    int64_t For::trips() {
+        if (!from->is_const() || !to->is_const()) {
+            return -1;
+        }
+        int64_t trips = reversed ? from->value - to->value + 1 : to->value - from->value + 1;
+        return trips > 0 ? trips : 0;
     }
 
     // DONE
-    std::vector<Instruction*> Read::gen_ir(int64_t *cur_label) {
+    void Read::gen_ir(Context &ctx, Emitter &out) {
     
-        std::vector<Instruction*> output;
-        if (!symbols.set_initialized(identifier)) {
-            error(identifier->name+" not defined", line);
-            return output;
+        if (!ctx.symbols.set_initialized(identifier)) {
+            error(ctx, std::string(identifier->name) + " not defined", line);
+            return;
         } 
         
         if (identifier->type() == 1) {
             // załaduj symbol
-            Instruction::GET(output,cur_label);
+            Instruction::GET(out);
             // oblicz miejsce w pamięci i wrzuć wartość do tej komórki 
-            int64_t off = symbols.get_symbol(identifier->name).offset_id; 
-            auto idx = (((ast::ConstArray*)identifier)->idx+2 - symbols.get_symbol(identifier->name).idx_b);
-            Instruction::STORE(output,off+idx, cur_label);
+            int64_t off = ctx.symbols.get_symbol(identifier).offset_id; 
+            auto idx = (((ast::ConstArray*)identifier)->idx+2 - ctx.symbols.get_symbol(identifier).idx_b);
+            Instruction::STORE(out, off+idx);
         } else if (identifier->type() == 2) {
             // load size
-            Instruction::LOAD(output, symbols.get_symbol(identifier->name).offset_id, cur_label);
+            Instruction::LOAD(out, ctx.symbols.get_symbol(identifier).offset_id);
             // odejmij index startowy od size'a
-            Instruction::SUB(output,  symbols.get_symbol(identifier->name).offset_id+1, cur_label);
+            Instruction::SUB(out, ctx.symbols.get_symbol(identifier).offset_id+1);
             // dodaj 2 bo prawidziwy size = n+2
-            Instruction::INC(output, cur_label);
-            Instruction::INC(output, cur_label);
+            Instruction::INC(out);
+            Instruction::INC(out);
             //dodaj szukany index, przechowaj wszystko w tempie
-            Instruction::ADD(output, symbols.get_symbol(((ast::VarArray*)identifier)->index->name).offset_id, cur_label);
-            int64_t temp = symbols.offset; symbols.offset++;
-            Instruction::STORE(output, temp, cur_label);
+            Instruction::ADD(out, ctx.symbols.get_symbol(((ast::VarArray*)identifier)->index).offset_id);
+            int64_t temp = ctx.symbols.offset; ctx.symbols.offset++;
+            Instruction::STORE(out, temp);
             // pobierz wartość i przechowaj ją w komórce pamięci obliczonej wcześniej
-            Instruction::GET(output,cur_label);
-            Instruction::STOREI(output, temp, cur_label);
+            Instruction::GET(out);
+            Instruction::STOREI(out, temp);
         } else {
-            Instruction::GET(output,cur_label);
-            Instruction::STORE(output, symbols.get_symbol(identifier->name).offset_id, cur_label);
+            Instruction::GET(out);
+            Instruction::STORE(out, ctx.symbols.get_symbol(identifier).offset_id);
         }
-
-        return output;
     }
     // DONE
-    std::vector<Instruction*> Write::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> output;
-        if (!check_init(value)) {
-            return output;
+    void Write::gen_ir(Context &ctx, Emitter &out) {
+        if (!check_init(ctx, value)) {
+            return;
         }
-        output = load_value(value, cur_label);
-        Instruction::PUT(output, cur_label);
-        return output;
+        load_value(ctx, value, out);
+        Instruction::PUT(out);
     }
     // DONE
-    std::vector<Instruction*> Const::gen_ir(int64_t *cur_label) {
-        if (!check_init(left)) {
-            return std::vector<Instruction*>();
+    void Const::gen_ir(Context &ctx, Emitter &out) {
+        if (!check_init(ctx, left)) {
+            return;
         }
-        return load_value(left, cur_label);
+        load_value(ctx, left, out);
     }
     // DONE
-    std::vector<Instruction*> Plus::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> output;
-        if(!(check_init(left) && check_init(right))) {
-            return output;
+    void Plus::gen_ir(Context &ctx, Emitter &out) {
+        int64_t cell;
+        if(!(check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
 
         if (left->is_const() && right->is_const()) {
             int64_t number = left->value + right->value;
-            output = generate_number(number, cur_label);
+            folded(ctx, out, left, "PLUS", right, number);
+            generate_number(ctx, number, out);
         } else if (left->is_const() || right-> is_const()) {
             auto constant = left->is_const() ? left : right;
             auto variable = left->is_const() ? right : left;
             if(constant->value == 1) {
-                insert_back(output, load_value(variable,cur_label));
-                Instruction::INC(output, cur_label);
+                if (ctx.generator.remarks.enabled()) {
+                    ctx.generator.remarks.passed("increment", out.line, "adding 1 to " + operand(variable) + " uses INC");
+                }
+                load_value(ctx, variable, out);
+                Instruction::INC(out);
+            } else if (direct_cell(ctx, variable, cell)) {
+                constant->gen_ir(ctx, out);
+                Instruction::ADD(out, cell);
             } else {
-                output = constant->gen_ir(cur_label);
-                Instruction::STORE(output, symbols.offset, cur_label);
-                int64_t const_mem_num = symbols.offset; symbols.offset++;
-                insert_back(output, load_value(variable, cur_label));
-                Instruction::ADD(output,const_mem_num, cur_label);
+                spilled(ctx, out, constant);
+                constant->gen_ir(ctx, out);
+                Instruction::STORE(out, ctx.symbols.offset);
+                int64_t const_mem_num = ctx.symbols.offset; ctx.symbols.offset++;
+                load_value(ctx, variable, out);
+                Instruction::ADD(out, const_mem_num);
             }
+        } else if (direct_cell(ctx, right, cell)) {
+            load_value(ctx, left, out);
+            Instruction::ADD(out, cell);
+        } else if (direct_cell(ctx, left, cell)) {
+            load_value(ctx, right, out);
+            Instruction::ADD(out, cell);
         } else {
-            insert_back(output, load_value(left, cur_label));
-            int64_t addition = symbols.offset; symbols.offset++;
-            Instruction::STORE(output, addition, cur_label);
-            insert_back(output, load_value(right, cur_label));
-            Instruction::ADD(output, addition ,cur_label);    
+            spilled(ctx, out, left);
+            load_value(ctx, left, out);
+            int64_t addition = ctx.symbols.offset; ctx.symbols.offset++;
+            Instruction::STORE(out, addition);
+            load_value(ctx, right, out);
+            Instruction::ADD(out, addition);    
         }
-        return output;
     }
 
     // DONE
-    std::vector<Instruction*> Minus::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> output;
-        if (!(check_init(left) && check_init(right))) {
-            return output;
+    void Minus::gen_ir(Context &ctx, Emitter &out) {
+        int64_t cell;
+        if (!(check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
 
         if (left->is_const() && right->is_const()) {
             int64_t num = left->value - right->value;
-            output = generate_number(num, cur_label);
+            folded(ctx, out, left, "MINUS", right, num);
+            generate_number(ctx, num, out);
+        } else if (left->is_const() && direct_cell(ctx, right, cell)) {
+            left->gen_ir(ctx, out);
+            Instruction::SUB(out, cell);
         } else if (left->is_const()) {
-            insert_back(output, load_value(right, cur_label));
-            int64_t subtraction = symbols.offset; symbols.offset++;
-            Instruction::STORE(output, subtraction, cur_label);
-            insert_back(output, left->gen_ir(cur_label));
-            Instruction::SUB(output, subtraction, cur_label);
+            spilled(ctx, out, right);
+            load_value(ctx, right, out);
+            int64_t subtraction = ctx.symbols.offset; ctx.symbols.offset++;
+            Instruction::STORE(out, subtraction);
+            left->gen_ir(ctx, out);
+            Instruction::SUB(out, subtraction);
         } else if (right->is_const()) {
-            insert_back(output, right->gen_ir(cur_label));
-            int64_t subtraction = symbols.offset; symbols.offset++;
-            Instruction::STORE(output, subtraction, cur_label);
-            insert_back(output, load_value(left, cur_label));
-            Instruction::SUB(output, subtraction, cur_label);
+            spilled(ctx, out, right);
+            right->gen_ir(ctx, out);
+            int64_t subtraction = ctx.symbols.offset; ctx.symbols.offset++;
+            Instruction::STORE(out, subtraction);
+            load_value(ctx, left, out);
+            Instruction::SUB(out, subtraction);
+        } else if (direct_cell(ctx, right, cell)) {
+            load_value(ctx, left, out);
+            Instruction::SUB(out, cell);
         } else {
-            insert_back(output, load_value(right, cur_label));
-            int64_t subtaction = symbols.offset; symbols.offset++;
-            Instruction::STORE(output, subtaction, cur_label);
-            insert_back(output, load_value(left, cur_label));
-            Instruction::SUB(output, subtaction ,cur_label);    
+            spilled(ctx, out, right);
+            load_value(ctx, right, out);
+            int64_t subtaction = ctx.symbols.offset; ctx.symbols.offset++;
+            Instruction::STORE(out, subtaction);
+            load_value(ctx, left, out);
+            Instruction::SUB(out, subtaction);    
         }
-        return output;
     }
     //DONE
-    std::vector<Instruction*> Times::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> output;
-        if (!(check_init(left) && check_init(right))) {
-            return output;
+    void Times::gen_ir(Context &ctx, Emitter &out) {
+        if (!(check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
+        size_t begin = out.code.size();
         if (left->is_const() && right->is_const()) {
             int64_t num = left->value * right->value;
-            return generate_number(num, cur_label);
+            folded(ctx, out, left, "TIMES", right, num);
+            generate_number(ctx, num, out);
+            return;
         } else if (left->is_const() || right->is_const()) {
             Value *constant = left->is_const() ? left : right;
             Value *ref = left->is_const() ? right : left;
+            if (ctx.generator.remarks.enabled()) {
+                ctx.generator.remarks.passed("strength-reduction", out.line, constant->value == 0
+                    ? "multiplication by 0 replaced by constant 0"
+                    : constant->value == 1 ? "multiplication by 1 replaced by a load of " + operand(ref)
+                    : "multiplication by constant " + operand(constant) + " unrolled into shifts and additions");
+            }
             if (constant->value == 0) {
-                insert_back(output, generate_number(0, cur_label));
+                generate_number(ctx, 0, out);
             } else if (constant->value == 1) {
-                output = ref->gen_ir(cur_label);
-                return output;
+                ref->gen_ir(ctx, out);
+                return;
             } else {
                 int64_t multiplier = 1;
                 bool sign_const = constant->value > 0 ? true : false; 
                 int64_t target = std::abs(constant->value);
-                int64_t one = symbols.offset; symbols.offset++;
-                int64_t single_value_offset = symbols.offset; symbols.offset++;
-                int64_t ref_offest = symbols.offset; symbols.offset++;
-                int64_t result = symbols.offset; symbols.offset++;
-                int64_t sign_offset = symbols.offset; symbols.offset++;
-
-                Instruction::SUB(output, 0, cur_label);
-                Instruction::STORE(output, result, cur_label);
-                Instruction::STORE(output, sign_offset, cur_label);
-                Instruction::INC(output, cur_label);
-                Instruction::STORE(output, one, cur_label);
-
-                insert_back(output, load_value(ref, cur_label));
-                Instruction::JNEG(output, *cur_label+4, cur_label);
-                Instruction *jump_to_end_if_zero = Instruction::JZERO(Instruction::Undef, cur_label); 
-                output.push_back(jump_to_end_if_zero);
-                Instruction::STORE(output, ref_offest, cur_label);
-                Instruction::JUMP(output, *cur_label+8, cur_label);
-
-                Instruction::STORE(output, ref_offest, cur_label);
-                Instruction::SUB(output, 0, cur_label);
-                Instruction::SUB(output, ref_offest, cur_label);
-                Instruction::STORE(output, ref_offest, cur_label);
-                Instruction::LOAD(output, sign_offset, cur_label);
-                Instruction::DEC(output, cur_label);
-                Instruction::STORE(output, sign_offset, cur_label);
-
-                Instruction::LOAD(output, ref_offest, cur_label);
-                Instruction::STORE(output, single_value_offset, cur_label);
+                int64_t one = ctx.symbols.offset; ctx.symbols.offset++;
+                int64_t single_value_offset = ctx.symbols.offset; ctx.symbols.offset++;
+                int64_t ref_offest = ctx.symbols.offset; ctx.symbols.offset++;
+                int64_t result = ctx.symbols.offset; ctx.symbols.offset++;
+                int64_t sign_offset = ctx.symbols.offset; ctx.symbols.offset++;
+
+                Instruction::SUB(out, 0);
+                Instruction::STORE(out, result);
+                Instruction::STORE(out, sign_offset);
+                Instruction::INC(out);
+                Instruction::STORE(out, one);
+
+                load_value(ctx, ref, out);
+                Instruction::JNEG(out, out.label+4);
+                Pending jump_to_end_if_zero = Instruction::JZERO(out);
+                Instruction::STORE(out, ref_offest);
+                Instruction::JUMP(out, out.label+8);
+
+                Instruction::STORE(out, ref_offest);
+                Instruction::SUB(out, 0);
+                Instruction::SUB(out, ref_offest);
+                Instruction::STORE(out, ref_offest);
+                Instruction::LOAD(out, sign_offset);
+                Instruction::DEC(out);
+                Instruction::STORE(out, sign_offset);
+
+                Instruction::LOAD(out, ref_offest);
+                Instruction::STORE(out, single_value_offset);
 
                 
                 while (!(target == 1) && !(target == 0)) {
@@ -574,725 +715,669 @@ namespace ast {
                     multiplier = 1;
 
                     while (multiplier * 2 < target) {
-                        Instruction::SHIFT(output, one, cur_label);
+                        Instruction::SHIFT(out, one);
                         multiplier*=2;
                     }
                     
                     target -= multiplier;
-                    Instruction::ADD(output, result, cur_label);
-                    Instruction::STORE(output, result, cur_label);
-                    Instruction::LOAD(output, single_value_offset, cur_label);
+                    Instruction::ADD(out, result);
+                    Instruction::STORE(out, result);
+                    Instruction::LOAD(out, single_value_offset);
 
                 }
 
                 if (target == 1) {
-                    Instruction::LOAD(output, result, cur_label);
-                    Instruction::ADD(output, single_value_offset, cur_label);
-                    Instruction::STORE(output, result, cur_label);
+                    Instruction::LOAD(out, result);
+                    Instruction::ADD(out, single_value_offset);
+                    Instruction::STORE(out, result);
                 }
                
                 //std::cout << sign_const << std::endl;
                 if (sign_const) {
-                    Instruction::LOAD(output, sign_offset, cur_label);
-                    Instruction::JNEG(output, *cur_label+3, cur_label);
-                    Instruction::LOAD(output, result, cur_label);
-                    Instruction::JUMP(output, *cur_label+3, cur_label);
-                    Instruction::SUB(output, 0, cur_label);
-                    Instruction::SUB(output, result, cur_label);
+                    Instruction::LOAD(out, sign_offset);
+                    Instruction::JNEG(out, out.label+3);
+                    Instruction::LOAD(out, result);
+                    Instruction::JUMP(out, out.label+3);
+                    Instruction::SUB(out, 0);
+                    Instruction::SUB(out, result);
                 } else {
-                    Instruction::LOAD(output, sign_offset, cur_label);
-                    Instruction::JZERO(output, *cur_label+3, cur_label);
-                    Instruction::LOAD(output, result, cur_label);
-                    Instruction::JUMP(output, *cur_label+3, cur_label);
-                    Instruction::SUB(output, 0, cur_label);
-                    Instruction::SUB(output, result, cur_label);
+                    Instruction::LOAD(out, sign_offset);
+                    Instruction::JZERO(out, out.label+3);
+                    Instruction::LOAD(out, result);
+                    Instruction::JUMP(out, out.label+3);
+                    Instruction::SUB(out, 0);
+                    Instruction::SUB(out, result);
                 }
-                jump_to_end_if_zero->arg = *cur_label;
+                jump_to_end_if_zero->arg = out.label;
 
-                return output;
+                return;
             }
         } else {
-            int64_t left_temp = symbols.offset; symbols.offset++;
-            int64_t left_temp2 = symbols.offset; symbols.offset++;
-            int64_t right_temp = symbols.offset; symbols.offset++;
-            int64_t sign = symbols.offset; symbols.offset++;
-            int64_t multiplier = symbols.offset; symbols.offset++;
-            int64_t one = symbols.offset; symbols.offset++;
-            int64_t neg_one = symbols.offset; symbols.offset++;
-            int64_t target = symbols.offset; symbols.offset++;
-            int64_t result = symbols.offset; symbols.offset++;
-
-            Instruction::SUB(output, 0, cur_label);
-            Instruction::STORE(output, result, cur_label);
-            Instruction::DEC(output, cur_label);
-            Instruction::STORE(output, neg_one, cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::STORE(output, one, cur_label);
-            Instruction::STORE(output, multiplier, cur_label);
+            int64_t left_temp = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t left_temp2 = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t right_temp = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t sign = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t multiplier = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t one = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t neg_one = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t target = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t result = ctx.symbols.offset; ctx.symbols.offset++;
+
+            Instruction::SUB(out, 0);
+            Instruction::STORE(out, result);
+            Instruction::STORE(out, sign);
+            Instruction::DEC(out);
+            Instruction::STORE(out, neg_one);
+            Instruction::INC(out);
+            Instruction::INC(out);
+            Instruction::STORE(out, one);
+            Instruction::STORE(out, multiplier);
 
             // loading left to temp and setting sign
-            insert_back(output, load_value(left, cur_label));
-            Instruction *jump_1_if_0 = Instruction::JZERO(Instruction::Undef, cur_label);
-            output.push_back(jump_1_if_0);
-
-            Instruction::JPOS(output, *cur_label+10, cur_label);
-            Instruction::STORE(output, left_temp, cur_label);
-            Instruction::SUB(output, 0 ,cur_label);
-            Instruction::SUB(output ,left_temp ,cur_label);
-            Instruction::STORE(output, left_temp, cur_label);
-            Instruction::STORE(output, left_temp2, cur_label);
-            Instruction::SUB(output ,0 ,cur_label);
-            Instruction::DEC(output, cur_label);
-            Instruction::STORE(output, sign, cur_label);
-            Instruction::JUMP(output, *cur_label+3, cur_label);
-            Instruction::STORE(output, left_temp, cur_label);
-            Instruction::STORE(output, left_temp2, cur_label);
+            load_value(ctx, left, out);
+            Pending jump_1_if_0 = Instruction::JZERO(out);
+
+            Instruction::JPOS(out, out.label+10);
+            Instruction::STORE(out, left_temp);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, left_temp);
+            Instruction::STORE(out, left_temp);
+            Instruction::STORE(out, left_temp2);
+            Instruction::SUB(out, 0);
+            Instruction::DEC(out);
+            Instruction::STORE(out, sign);
+            Instruction::JUMP(out, out.label+3);
+            Instruction::STORE(out, left_temp);
+            Instruction::STORE(out, left_temp2);
 
             // loading right and adjusting the sign
-            insert_back(output, load_value(right, cur_label));
-            Instruction *jump_2_if_0 = Instruction::JZERO(Instruction::Undef, cur_label);
-            output.push_back(jump_2_if_0);
-
-            Instruction::JPOS(output, *cur_label+13, cur_label);
-            Instruction::STORE(output, right_temp, cur_label);
-            Instruction::SUB(output ,0 ,cur_label);
-            Instruction::SUB(output ,right_temp ,cur_label);
-            Instruction::STORE(output, right_temp, cur_label);
-            Instruction::STORE(output, target, cur_label);
-            Instruction::LOAD(output, sign, cur_label);
-            Instruction::JNEG(output, *cur_label+3, cur_label);
-            Instruction::DEC(output, cur_label);
-            Instruction::JUMP(output, *cur_label+2, cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::STORE(output, sign, cur_label);
-            Instruction::JUMP(output, *cur_label+3, cur_label);
-            Instruction::STORE(output, right_temp, cur_label);
-            Instruction::STORE(output, target, cur_label);
+            load_value(ctx, right, out);
+            Pending jump_2_if_0 = Instruction::JZERO(out);
+
+            Instruction::JPOS(out, out.label+13);
+            Instruction::STORE(out, right_temp);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, right_temp);
+            Instruction::STORE(out, right_temp);
+            Instruction::STORE(out, target);
+            Instruction::LOAD(out, sign);
+            Instruction::JNEG(out, out.label+3);
+            Instruction::DEC(out);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::INC(out);
+            Instruction::STORE(out, sign);
+            Instruction::JUMP(out, out.label+3);
+            Instruction::STORE(out, right_temp);
+            Instruction::STORE(out, target);
 
             // while (!(target == 1) && !(target == 0)) // external loop
-            int64_t begin_loop = *cur_label;
-            Instruction::LOAD(output, target, cur_label);
-            Instruction *jump1 = Instruction::JZERO(Instruction::Undef, cur_label);
-            output.push_back(jump1);
-            Instruction::DEC(output, cur_label);
-            Instruction *jump2 = Instruction::JZERO(Instruction::Undef, cur_label);
-            output.push_back(jump2);
+            int64_t begin_loop = out.label;
+            Instruction::LOAD(out, target);
+            Pending jump1 = Instruction::JZERO(out);
+            Instruction::DEC(out);
+            Pending jump2 = Instruction::JZERO(out);
 
             //  multiplier = 1;
-            Instruction::SUB(output, 0 ,cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::STORE(output, multiplier, cur_label);
+            Instruction::SUB(out, 0);
+            Instruction::INC(out);
+            Instruction::STORE(out, multiplier);
 
             //until b - mult > 0 // internal loop
-            int64_t label_loop1_begin = *cur_label;
-            Instruction::LOAD(output, target, cur_label);
-            Instruction::SUB(output, multiplier, cur_label);
-            Instruction::JNEG(output, *cur_label+9, cur_label);
-            Instruction *jump_if_0 = Instruction::JZERO(Instruction::Undef, cur_label);
-            output.push_back(jump_if_0);
+            int64_t label_loop1_begin = out.label;
+            Instruction::LOAD(out, target);
+            Instruction::SUB(out, multiplier);
+            Instruction::JNEG(out, out.label+9);
+            Pending jump_if_0 = Instruction::JZERO(out);
             
             // mult = mult * 2 // left = left*2
-            Instruction::LOAD(output, multiplier, cur_label);
-            Instruction::SHIFT(output, one, cur_label);
-            Instruction::STORE(output, multiplier, cur_label);
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::SHIFT(output, one, cur_label);
-            Instruction::STORE(output, left_temp, cur_label);
+            Instruction::LOAD(out, multiplier);
+            Instruction::SHIFT(out, one);
+            Instruction::STORE(out, multiplier);
+            Instruction::LOAD(out, left_temp);
+            Instruction::SHIFT(out, one);
+            Instruction::STORE(out, left_temp);
             // end of internal loop
-            Instruction::JUMP(output, label_loop1_begin, cur_label);
+            Instruction::JUMP(out, label_loop1_begin);
 
             // when b - mult < 0 // mult = mult/2 // left = left/2
-            Instruction::LOAD(output, multiplier, cur_label);
-            Instruction::SHIFT(output, neg_one, cur_label);
-            Instruction::STORE(output, multiplier, cur_label);
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::SHIFT(output, neg_one, cur_label);
-            Instruction::STORE(output, left_temp, cur_label);
+            Instruction::LOAD(out, multiplier);
+            Instruction::SHIFT(out, neg_one);
+            Instruction::STORE(out, multiplier);
+            Instruction::LOAD(out, left_temp);
+            Instruction::SHIFT(out, neg_one);
+            Instruction::STORE(out, left_temp);
 
             // target -= multiplier;
-            jump_if_0->arg = *cur_label;
-            Instruction::LOAD(output, target, cur_label);
-            Instruction::SUB(output, multiplier, cur_label);
-            Instruction::STORE(output, target, cur_label);
-
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::ADD(output, result, cur_label);
-            Instruction::STORE(output, result, cur_label);
-            Instruction::LOAD(output, left_temp2, cur_label);
-            Instruction::STORE(output, left_temp, cur_label);
+            jump_if_0->arg = out.label;
+            Instruction::LOAD(out, target);
+            Instruction::SUB(out, multiplier);
+            Instruction::STORE(out, target);
+
+            Instruction::LOAD(out, left_temp);
+            Instruction::ADD(out, result);
+            Instruction::STORE(out, result);
+            Instruction::LOAD(out, left_temp2);
+            Instruction::STORE(out, left_temp);
             // end of external loop
-            Instruction::JUMP(output, begin_loop, cur_label);
+            Instruction::JUMP(out, begin_loop);
 
 
-            jump2->arg = *cur_label;
+            jump2->arg = out.label;
             // if target == 1
-            Instruction::LOAD(output, result, cur_label);
-            Instruction::ADD(output, left_temp2, cur_label);
-            Instruction::STORE(output, result, cur_label);
+            Instruction::LOAD(out, result);
+            Instruction::ADD(out, left_temp2);
+            Instruction::STORE(out, result);
 
 
-            jump1->arg = *cur_label;
+            jump1->arg = out.label;
             
 
-            Instruction::LOAD(output, sign, cur_label);
-            Instruction::JNEG(output, *cur_label+2, cur_label);
-            Instruction::JUMP(output, *cur_label+6, cur_label);
+            Instruction::LOAD(out, sign);
+            Instruction::JNEG(out, out.label+2);
+            Instruction::JUMP(out, out.label+6);
 
-            Instruction::LOAD(output, result, cur_label);
-            Instruction::SUB(output, 0, cur_label);
-            Instruction::SUB(output, result, cur_label);
-            Instruction::STORE(output, result, cur_label);
-            Instruction::JUMP(output, *cur_label+2, cur_label);
-            Instruction::LOAD(output, result, cur_label);
+            Instruction::LOAD(out, result);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, result);
+            Instruction::STORE(out, result);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::LOAD(out, result);
            
-            jump_1_if_0->arg = *cur_label;
-            jump_2_if_0->arg = *cur_label;
+            jump_1_if_0->arg = out.label;
+            jump_2_if_0->arg = out.label;
 
-        }   
+            if (ctx.generator.remarks.enabled()) {
+                ctx.generator.remarks.missed("strength-reduction", out.line, "no constant operand in "
+                    + operand(left) + " TIMES " + operand(right) + ", generic multiplication loop used",
+                    out.code.size() - begin, static_cost(out.code, begin));
+            }
 
-        return output;
+        }   
     }
 
     //DONE
-    std::vector<Instruction*> Div::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> output;
-        if (!(check_init(left) && check_init(right))) {
-            return output;
+    void Div::gen_ir(Context &ctx, Emitter &out) {
+        if (!(check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
 
+        size_t begin = out.code.size();
         if (left->is_const() && right->is_const()) {
-            int64_t num = left->value/right->value;
-            return generate_number(num, cur_label);
+            int64_t num = div_floor(left->value, right->value);
+            folded(ctx, out, left, "DIV", right, num);
+            generate_number(ctx, num, out);
+            return;
         } else {
-            int64_t left_temp = symbols.offset; symbols.offset++;
-            int64_t right_temp = symbols.offset; symbols.offset++;
-            int64_t sign = symbols.offset; symbols.offset++;
-            int64_t even = symbols.offset; symbols.offset++;
-            int64_t ta = symbols.offset; symbols.offset++;
-            int64_t one = symbols.offset; symbols.offset++;
-            int64_t shift_iter_offset = symbols.offset; symbols.offset++;
-            int64_t result_offset = symbols.offset; symbols.offset++;
-            int64_t temp_to_compare = symbols.offset; symbols.offset++;
-            int64_t temp_to_dec = symbols.offset; symbols.offset++;    
-
-            Instruction *jump_1_if_0; 
-            Instruction *jump_2_if_0;
-
-            Instruction::SUB(output,0,cur_label);
-            Instruction::STORE(output, result_offset, cur_label);
-
-            if (left->is_const()){
-                insert_back(output, generate_number(left->value, cur_label));
-                Instruction::STORE(output, left_temp, cur_label);
-            } else {
-                int64_t left_offset = symbols.offset; symbols.offset++; 
-               
-                insert_back(output, load_value(left, cur_label));
-                jump_1_if_0 = Instruction::JZERO(Instruction::Undef, cur_label);
-                output.push_back(jump_1_if_0);
-
-                Instruction::JPOS(output, *cur_label+9, cur_label);
-                Instruction::STORE(output, left_offset, cur_label);
-                Instruction::SUB(output, 0 ,cur_label);
-                Instruction::SUB(output ,left_offset ,cur_label);
-                Instruction::STORE(output, left_temp, cur_label);
-                Instruction::SUB(output ,0 ,cur_label);
-                Instruction::DEC(output, cur_label);
-                Instruction::STORE(output, sign, cur_label);
-                Instruction::JUMP(output, *cur_label+2, cur_label);
-                Instruction::STORE(output, left_temp, cur_label);
-            }
-
-            if (right->is_const()){
-                insert_back(output, generate_number(right->value, cur_label));
-                Instruction::STORE(output, right_temp, cur_label);
-            } else {
-                int64_t right_offset = symbols.offset; symbols.offset++; 
-                
-                insert_back(output, load_value(right, cur_label));
-                jump_2_if_0 = Instruction::JZERO(Instruction::Undef, cur_label);
-                output.push_back(jump_2_if_0);
-
-                Instruction::JPOS(output, *cur_label+12, cur_label);
-                Instruction::STORE(output, right_offset, cur_label);
-                Instruction::SUB(output ,0 ,cur_label);
-                Instruction::SUB(output ,right_offset ,cur_label);
-                Instruction::STORE(output, right_temp, cur_label);
-                Instruction::LOAD(output, sign, cur_label);
-                Instruction::JNEG(output, *cur_label+3, cur_label);
-                Instruction::DEC(output, cur_label);
-                Instruction::JUMP(output, *cur_label+2, cur_label);
-                Instruction::INC(output, cur_label);
-                Instruction::STORE(output, sign, cur_label);
-                Instruction::JUMP(output, *cur_label+2, cur_label);
-                Instruction::STORE(output, right_temp, cur_label);
-            }
+            int64_t left_temp = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t right_temp = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t sign = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t even = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t ta = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t one = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t shift_iter_offset = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t result_offset = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t temp_to_compare = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t temp_to_dec = ctx.symbols.offset; ctx.symbols.offset++;    
+
+            Pending jump_1_if_0; 
+            Pending jump_2_if_0;
+
+            Instruction::SUB(out, 0);
+            Instruction::STORE(out, result_offset);
+            Instruction::STORE(out, sign);
+
+            // stałe przechodzą tą samą ścieżką co zmienne (znak i zero)
+            int64_t left_offset = ctx.symbols.offset; ctx.symbols.offset++; 
+           
+            load_value(ctx, left, out);
+            jump_1_if_0 = Instruction::JZERO(out);
+
+            Instruction::JPOS(out, out.label+9);
+            Instruction::STORE(out, left_offset);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, left_offset);
+            Instruction::STORE(out, left_temp);
+            Instruction::SUB(out, 0);
+            Instruction::DEC(out);
+            Instruction::STORE(out, sign);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::STORE(out, left_temp);
+
+            int64_t right_offset = ctx.symbols.offset; ctx.symbols.offset++; 
+            
+            load_value(ctx, right, out);
+            jump_2_if_0 = Instruction::JZERO(out);
+
+            Instruction::JPOS(out, out.label+12);
+            Instruction::STORE(out, right_offset);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, right_offset);
+            Instruction::STORE(out, right_temp);
+            Instruction::LOAD(out, sign);
+            Instruction::JNEG(out, out.label+3);
+            Instruction::DEC(out);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::INC(out);
+            Instruction::STORE(out, sign);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::STORE(out, right_temp);
 
             // Ustawianie potrzebnych zmiennych pomocniczych
-            Instruction::SUB(output,0,cur_label);
-            Instruction::STORE(output, temp_to_dec, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::STORE(output, one, cur_label);
-            Instruction::DEC(output, cur_label);
-            Instruction::DEC(output, cur_label);
-            Instruction::STORE(output, even, cur_label);
-            Instruction::LOAD(output, right_temp, cur_label);
-            Instruction::STORE(output, temp_to_compare, cur_label);
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::STORE(output, ta, cur_label);
+            Instruction::SUB(out, 0);
+            Instruction::STORE(out, temp_to_dec);
+            Instruction::STORE(out, shift_iter_offset);
+            Instruction::INC(out);
+            Instruction::STORE(out, one);
+            Instruction::DEC(out);
+            Instruction::DEC(out);
+            Instruction::STORE(out, even);
+            Instruction::LOAD(out, right_temp);
+            Instruction::STORE(out, temp_to_compare);
+            Instruction::LOAD(out, left_temp);
+            Instruction::STORE(out, ta);
 
 
             // Comparing and checking a-2^i*b > 0
-            int64_t label_begin = *cur_label;
-            Instruction::LOAD(output, ta, cur_label);
-            Instruction::SUB(output, temp_to_compare, cur_label);
-            Instruction::JNEG(output, *cur_label+9 ,cur_label); 
-            Instruction *jump_to_end_if_zero = Instruction::JZERO(Instruction::Undef, cur_label); 
-            output.push_back(jump_to_end_if_zero);
+            int64_t label_begin = out.label;
+            Instruction::LOAD(out, ta);
+            Instruction::SUB(out, temp_to_compare);
+            Instruction::JNEG(out, out.label+9); 
+            Pending jump_to_end_if_zero = Instruction::JZERO(out);
 
             // i++ and temp_to_compare*=2^i
-            Instruction::LOAD(output, shift_iter_offset, cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
-            Instruction::LOAD(output, temp_to_compare, cur_label);
-            Instruction::SHIFT(output, one, cur_label);
-            Instruction::STORE(output, temp_to_compare, cur_label);
-            Instruction::JUMP(output, *cur_label-10, cur_label);
+            Instruction::LOAD(out, shift_iter_offset);
+            Instruction::INC(out);
+            Instruction::STORE(out, shift_iter_offset);
+            Instruction::LOAD(out, temp_to_compare);
+            Instruction::SHIFT(out, one);
+            Instruction::STORE(out, temp_to_compare);
+            Instruction::JUMP(out, out.label-10);
 
 
             // wyjście z minipętli
-            Instruction::LOAD(output, shift_iter_offset, cur_label);
-            Instruction::DEC(output, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
+            Instruction::LOAD(out, shift_iter_offset);
+            Instruction::DEC(out);
+            Instruction::STORE(out, shift_iter_offset);
 
             // if iter == 0 it is end
-            Instruction *jump_to_end_if_neg = Instruction::JNEG(Instruction::Undef, cur_label); 
-            output.push_back(jump_to_end_if_neg);
+            Pending jump_to_end_if_neg = Instruction::JNEG(out);
 
             // usalwianie even żby odejmować dla ujemnych
-            Instruction::JUMP(output, *cur_label+2, cur_label);
-            jump_to_end_if_zero->arg = *cur_label;
-            //Instruction::INC(output, cur_label);
-            Instruction::STORE(output, even, cur_label);
+            Instruction::JUMP(out, out.label+2);
+            jump_to_end_if_zero->arg = out.label;
+            //Instruction::INC(out);
+            Instruction::STORE(out, even);
 
             // result += result+2^i
-            Instruction::SUB(output, 0 ,cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::SHIFT(output, shift_iter_offset, cur_label);
-            Instruction::ADD(output, result_offset, cur_label);
-            Instruction::STORE(output, result_offset, cur_label);
+            Instruction::SUB(out, 0);
+            Instruction::INC(out);
+            Instruction::SHIFT(out, shift_iter_offset);
+            Instruction::ADD(out, result_offset);
+            Instruction::STORE(out, result_offset);
 
             // temp_to_dec = (2^i)*b
-            Instruction::LOAD(output, right_temp, cur_label);
-            Instruction::SHIFT(output, shift_iter_offset, cur_label);
-            Instruction::STORE(output, temp_to_dec, cur_label);
+            Instruction::LOAD(out, right_temp);
+            Instruction::SHIFT(out, shift_iter_offset);
+            Instruction::STORE(out, temp_to_dec);
 
             // ta = ta - temp_to_dec
-            Instruction::LOAD(output, ta, cur_label);
-            Instruction::SUB(output, temp_to_dec, cur_label);
-            Instruction::STORE(output, ta, cur_label);
+            Instruction::LOAD(out, ta);
+            Instruction::SUB(out, temp_to_dec);
+            Instruction::STORE(out, ta);
 
             // iterator and comparator = 0
-            Instruction::SUB(output, 0, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
-            Instruction::LOAD(output, right_temp, cur_label);
-            Instruction::STORE(output, temp_to_compare, cur_label);
+            Instruction::SUB(out, 0);
+            Instruction::STORE(out, shift_iter_offset);
+            Instruction::LOAD(out, right_temp);
+            Instruction::STORE(out, temp_to_compare);
 
             // jump back to begin
-            Instruction::JUMP(output, label_begin, cur_label);
+            Instruction::JUMP(out, label_begin);
 
-            jump_to_end_if_neg->arg = *cur_label;
+            jump_to_end_if_neg->arg = out.label;
 
-            Instruction::LOAD(output, sign, cur_label);
-            Instruction::JNEG(output, *cur_label+2, cur_label);
-            Instruction::JUMP(output, *cur_label+9, cur_label);
+            Instruction::LOAD(out, sign);
+            Instruction::JNEG(out, out.label+2);
+            Instruction::JUMP(out, out.label+9);
 
-            Instruction::LOAD(output, result_offset, cur_label);
-            Instruction::SUB(output, 0, cur_label);
-            Instruction::SUB(output, result_offset, cur_label);
-            Instruction::STORE(output, result_offset, cur_label);
-            Instruction::LOAD(output, even, cur_label);
-            Instruction::JZERO(output, *cur_label+3, cur_label);
-            Instruction::ADD(output, result_offset, cur_label);
-            Instruction::JUMP(output, *cur_label+2, cur_label);
-            Instruction::LOAD(output, result_offset, cur_label);
+            Instruction::LOAD(out, result_offset);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, result_offset);
+            Instruction::STORE(out, result_offset);
+            Instruction::LOAD(out, even);
+            Instruction::JZERO(out, out.label+3);
+            Instruction::ADD(out, result_offset);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::LOAD(out, result_offset);
 
-            jump_1_if_0->arg = *cur_label;
-            jump_2_if_0->arg = *cur_label;
+            jump_1_if_0->arg = out.label;
+            jump_2_if_0->arg = out.label;
 
-            return output;
+            divided(ctx, out, left, "DIV", right, begin);
+            return;
         }
     }
 
     // DONE
-    std::vector<Instruction*> Mod::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> output;
-        if (!(check_init(left) && check_init(right))) {
-            return output;
+    void Mod::gen_ir(Context &ctx, Emitter &out) {
+        if (!(check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
 
+        size_t begin = out.code.size();
         if (left->is_const() && right->is_const()) {
-            int64_t num = left->value%right->value;
-            return generate_number(num, cur_label);
+            int64_t num = mod_floor(left->value, right->value);
+            folded(ctx, out, left, "MOD", right, num);
+            generate_number(ctx, num, out);
+            return;
         } else {
             
-            int64_t left_temp = symbols.offset; symbols.offset++;
-            int64_t right_temp = symbols.offset; symbols.offset++;
-            int64_t sign_left = symbols.offset; symbols.offset++;
-            int64_t sign_right = symbols.offset; symbols.offset++;
-            int64_t ta = symbols.offset; symbols.offset++;
-            int64_t one = symbols.offset; symbols.offset++;
-            int64_t shift_iter_offset = symbols.offset; symbols.offset++;
-            int64_t result_offset = symbols.offset; symbols.offset++;
-            int64_t temp_to_compare = symbols.offset; symbols.offset++;
-            int64_t temp_to_dec = symbols.offset; symbols.offset++;    
-
-            Instruction *jump_1_if_0; 
-            Instruction *jump_2_if_0;
-
-            Instruction::SUB(output,0,cur_label);
-            Instruction::STORE(output, result_offset, cur_label);
-            Instruction::STORE(output, sign_left, cur_label);
-            Instruction::STORE(output, sign_right, cur_label);
-
-            if (left->is_const()){
-                insert_back(output, generate_number(left->value, cur_label));
-                Instruction::STORE(output, left_temp, cur_label);
-            } else {
-                int64_t left_offset = symbols.offset; symbols.offset++;
-               
-                insert_back(output, load_value(left, cur_label));
-                jump_1_if_0 = Instruction::JZERO(Instruction::Undef, cur_label);
-                output.push_back(jump_1_if_0);
-
-                Instruction::JPOS(output, *cur_label+9, cur_label);
-                Instruction::STORE(output, left_offset, cur_label);
-                Instruction::SUB(output, 0 ,cur_label);
-                Instruction::SUB(output ,left_offset ,cur_label);
-                Instruction::STORE(output, left_temp, cur_label);
-                Instruction::SUB(output ,0 ,cur_label);
-                Instruction::DEC(output, cur_label);
-                Instruction::STORE(output, sign_left, cur_label);
-                Instruction::JUMP(output, *cur_label+2, cur_label);
-                Instruction::STORE(output, left_temp, cur_label);
-            }
-
-            if (right->is_const()){
-                insert_back(output, generate_number(right->value, cur_label));
-                Instruction::STORE(output, right_temp, cur_label);
-            } else {
-                int64_t right_offset = symbols.offset; symbols.offset++;
-                
-                insert_back(output, load_value(right, cur_label));
-                jump_2_if_0 = Instruction::JZERO(Instruction::Undef, cur_label);
-                output.push_back(jump_2_if_0);
-
-                Instruction::JPOS(output, *cur_label+9, cur_label);
-                Instruction::STORE(output, right_offset, cur_label);
-                Instruction::SUB(output, 0 ,cur_label);
-                Instruction::SUB(output ,right_offset ,cur_label);
-                Instruction::STORE(output, right_temp, cur_label);
-                Instruction::SUB(output ,0 ,cur_label);
-                Instruction::DEC(output, cur_label);
-                Instruction::STORE(output, sign_right, cur_label);
-                Instruction::JUMP(output, *cur_label+2, cur_label);
-                Instruction::STORE(output, right_temp, cur_label);
-            }
+            int64_t left_temp = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t right_temp = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t sign_left = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t sign_right = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t ta = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t one = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t shift_iter_offset = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t result_offset = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t temp_to_compare = ctx.symbols.offset; ctx.symbols.offset++;
+            int64_t temp_to_dec = ctx.symbols.offset; ctx.symbols.offset++;    
+
+            Pending jump_1_if_0; 
+            Pending jump_2_if_0;
+
+            Instruction::SUB(out, 0);
+            Instruction::STORE(out, result_offset);
+            Instruction::STORE(out, sign_left);
+            Instruction::STORE(out, sign_right);
+
+            // stałe przechodzą tą samą ścieżką co zmienne (znak i zero)
+            int64_t left_offset = ctx.symbols.offset; ctx.symbols.offset++;
+           
+            load_value(ctx, left, out);
+            jump_1_if_0 = Instruction::JZERO(out);
+
+            Instruction::JPOS(out, out.label+9);
+            Instruction::STORE(out, left_offset);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, left_offset);
+            Instruction::STORE(out, left_temp);
+            Instruction::SUB(out, 0);
+            Instruction::DEC(out);
+            Instruction::STORE(out, sign_left);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::STORE(out, left_temp);
+
+            int64_t right_offset = ctx.symbols.offset; ctx.symbols.offset++;
+            
+            load_value(ctx, right, out);
+            jump_2_if_0 = Instruction::JZERO(out);
+
+            Instruction::JPOS(out, out.label+9);
+            Instruction::STORE(out, right_offset);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, right_offset);
+            Instruction::STORE(out, right_temp);
+            Instruction::SUB(out, 0);
+            Instruction::DEC(out);
+            Instruction::STORE(out, sign_right);
+            Instruction::JUMP(out, out.label+2);
+            Instruction::STORE(out, right_temp);
 
             // Ustawianie potrzebnych zmiennych pomocniczych
-            Instruction::SUB(output,0,cur_label);
-            Instruction::STORE(output, temp_to_dec, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::STORE(output, one, cur_label);
-            Instruction::LOAD(output, right_temp, cur_label);
-            Instruction::STORE(output, temp_to_compare, cur_label);
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::STORE(output, ta, cur_label);
+            Instruction::SUB(out, 0);
+            Instruction::STORE(out, temp_to_dec);
+            Instruction::STORE(out, shift_iter_offset);
+            Instruction::INC(out);
+            Instruction::STORE(out, one);
+            Instruction::LOAD(out, right_temp);
+            Instruction::STORE(out, temp_to_compare);
+            Instruction::LOAD(out, left_temp);
+            Instruction::STORE(out, ta);
 
 
 
             // Comparing and checking a-2^i*b > 0
-            int64_t label_begin = *cur_label;
-            Instruction::LOAD(output, ta, cur_label);
-            Instruction::SUB(output, temp_to_compare, cur_label);
-            Instruction::JNEG(output, *cur_label+9 ,cur_label); 
-            Instruction *jump_to_end_if_zero = Instruction::JZERO(Instruction::Undef, cur_label); 
-            output.push_back(jump_to_end_if_zero);
+            int64_t label_begin = out.label;
+            Instruction::LOAD(out, ta);
+            Instruction::SUB(out, temp_to_compare);
+            Instruction::JNEG(out, out.label+9); 
+            Pending jump_to_end_if_zero = Instruction::JZERO(out);
 
             // i++ and temp_to_compare*=2^i
-            Instruction::LOAD(output, shift_iter_offset, cur_label);
-            Instruction::INC(output, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
-            Instruction::LOAD(output, temp_to_compare, cur_label);
-            Instruction::SHIFT(output, one, cur_label);
-            Instruction::STORE(output, temp_to_compare, cur_label);
-            Instruction::JUMP(output, *cur_label-10, cur_label);
+            Instruction::LOAD(out, shift_iter_offset);
+            Instruction::INC(out);
+            Instruction::STORE(out, shift_iter_offset);
+            Instruction::LOAD(out, temp_to_compare);
+            Instruction::SHIFT(out, one);
+            Instruction::STORE(out, temp_to_compare);
+            Instruction::JUMP(out, out.label-10);
 
             // wyjście z minipętli
-            Instruction::LOAD(output, shift_iter_offset, cur_label);
-            Instruction::DEC(output, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
+            Instruction::LOAD(out, shift_iter_offset);
+            Instruction::DEC(out);
+            Instruction::STORE(out, shift_iter_offset);
 
             // if iter < 0 it is end
-            Instruction *jump_to_end_if_neg = Instruction::JNEG(Instruction::Undef, cur_label); 
-            output.push_back(jump_to_end_if_neg);
+            Pending jump_to_end_if_neg = Instruction::JNEG(out);
 
             // temp_to_dec = (2^i)*b
             // result += (2^i)*b
-            Instruction::LOAD(output, right_temp, cur_label);
-            Instruction::SHIFT(output, shift_iter_offset, cur_label);
-            Instruction::STORE(output, temp_to_dec, cur_label);
-            Instruction::ADD(output, result_offset, cur_label);
-            Instruction::STORE(output, result_offset, cur_label);
+            Instruction::LOAD(out, right_temp);
+            Instruction::SHIFT(out, shift_iter_offset);
+            Instruction::STORE(out, temp_to_dec);
+            Instruction::ADD(out, result_offset);
+            Instruction::STORE(out, result_offset);
 
             // ta = ta - temp_to_dec
-            Instruction::LOAD(output, ta, cur_label);
-            Instruction::SUB(output, temp_to_dec, cur_label);
-            Instruction::STORE(output, ta, cur_label);
+            Instruction::LOAD(out, ta);
+            Instruction::SUB(out, temp_to_dec);
+            Instruction::STORE(out, ta);
 
             // iterator and comparator = 0
-            Instruction::SUB(output, 0, cur_label);
-            Instruction::STORE(output, shift_iter_offset, cur_label);
-            Instruction::LOAD(output, right_temp, cur_label);
-            Instruction::STORE(output, temp_to_compare, cur_label);
+            Instruction::SUB(out, 0);
+            Instruction::STORE(out, shift_iter_offset);
+            Instruction::LOAD(out, right_temp);
+            Instruction::STORE(out, temp_to_compare);
 
             // jump back to begin
-            Instruction::JUMP(output, label_begin, cur_label);
+            Instruction::JUMP(out, label_begin);
 
-            jump_to_end_if_neg->arg = *cur_label;
+            jump_to_end_if_neg->arg = out.label;
 
 
             // CHECKING FOR SIGN
-            Instruction::LOAD(output, sign_left, cur_label);
-            Instruction *left_negative = Instruction::JNEG(Instruction::Undef, cur_label); 
-            output.push_back(left_negative);
-            Instruction::LOAD(output, sign_right, cur_label);
-            Instruction::JNEG(output, *cur_label+4, cur_label);
+            Instruction::LOAD(out, sign_left);
+            Pending left_negative = Instruction::JNEG(out);
+            Instruction::LOAD(out, sign_right);
+            Instruction::JNEG(out, out.label+4);
             
             // both positives
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::SUB(output, result_offset, cur_label);
-            Instruction *jump_end1 = Instruction::JUMP(Instruction::Undef, cur_label); 
-            output.push_back(jump_end1);
+            Instruction::LOAD(out, left_temp);
+            Instruction::SUB(out, result_offset);
+            Pending jump_end1 = Instruction::JUMP(out);
 
             // left positive, right negative
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::SUB(output, result_offset, cur_label);
-            Instruction::SUB(output, right_temp, cur_label);
-            Instruction *jump_end2 = Instruction::JUMP(Instruction::Undef, cur_label); 
-            output.push_back(jump_end2);
+            Instruction::LOAD(out, left_temp);
+            Instruction::SUB(out, result_offset);
+            Instruction::SUB(out, right_temp);
+            Pending jump_end2 = Instruction::JUMP(out);
 
-            left_negative->arg = *cur_label;
+            left_negative->arg = out.label;
             
-            Instruction::LOAD(output, sign_right, cur_label);
-            Instruction::JNEG(output, *cur_label+7, cur_label);
+            Instruction::LOAD(out, sign_right);
+            Instruction::JNEG(out, out.label+7);
 
             //left negative, right positive
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::SUB(output, result_offset, cur_label);
-            Instruction::STORE(output, result_offset, cur_label);
-            Instruction::LOAD(output, right_temp, cur_label);
-            Instruction::SUB(output, result_offset, cur_label);
-            Instruction *jump_end3 = Instruction::JUMP(Instruction::Undef, cur_label); 
-            output.push_back(jump_end3);
+            Instruction::LOAD(out, left_temp);
+            Instruction::SUB(out, result_offset);
+            Instruction::STORE(out, result_offset);
+            Instruction::LOAD(out, right_temp);
+            Instruction::SUB(out, result_offset);
+            Pending jump_end3 = Instruction::JUMP(out);
 
             //both negative
-            Instruction::LOAD(output, left_temp, cur_label);
-            Instruction::SUB(output, result_offset, cur_label);
-            Instruction::STORE(output, result_offset, cur_label);
-            Instruction::SUB(output, 0, cur_label);
-            Instruction::SUB(output, result_offset, cur_label);
-
-            jump_end1->arg = *cur_label;
-            jump_end2->arg = *cur_label;
-            jump_end3->arg = *cur_label;
-
-            jump_1_if_0->arg = *cur_label;
-            jump_2_if_0->arg = *cur_label;
-            jump_to_end_if_zero->arg = *cur_label;
-
-            return output;
+            Instruction::LOAD(out, left_temp);
+            Instruction::SUB(out, result_offset);
+            Instruction::STORE(out, result_offset);
+            Instruction::SUB(out, 0);
+            Instruction::SUB(out, result_offset);
+
+            jump_end1->arg = out.label;
+            jump_end2->arg = out.label;
+            jump_end3->arg = out.label;
+
+            jump_1_if_0->arg = out.label;
+            jump_2_if_0->arg = out.label;
+            jump_to_end_if_zero->arg = out.label;
+
+            divided(ctx, out, left, "MOD", right, begin);
+            return;
         }
     }
 
-    std::vector<Instruction*> EQ::gen_ir(int64_t *cur_label) {
-         std::vector<Instruction*> out;
-        if (! (check_init(left) && check_init(right))) {
-            return out;
+    void EQ::gen_ir(Context &ctx, Emitter &out) {
+        if (! (check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
-        auto temp = Minus(left,right,line).gen_ir(cur_label);
-        out.insert(out.end(), temp.begin(), temp.end());
-        Instruction::JZERO(out,(*cur_label)+3,cur_label);
-        Instruction::SUB(out,0,cur_label);
-        Instruction::JUMP(out, (*cur_label)+2, cur_label);
-        Instruction::INC(out, cur_label);
-
-        return out;
+        Minus(left,right,line).gen_ir(ctx, out);
+        Instruction::JZERO(out, out.label+3);
+        Instruction::SUB(out, 0);
+        Instruction::JUMP(out, out.label+2);
+        Instruction::INC(out);
     }
 
-    std::vector<Instruction*> NEQ::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> out;
-        if (! (check_init(left) && check_init(right))) {
-            return out;
+    void NEQ::gen_ir(Context &ctx, Emitter &out) {
+        if (! (check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
-        auto temp = Minus(left,right,line).gen_ir(cur_label);
-        out.insert(out.end(), temp.begin(), temp.end());
-        Instruction::JZERO(out,(*cur_label)+4,cur_label);
-        Instruction::SUB(out,0,cur_label);
-        Instruction::INC(out, cur_label);
-        Instruction::JUMP(out, (*cur_label)+2, cur_label);
-        Instruction::SUB(out,0,cur_label);
-
-        return out;
+        Minus(left,right,line).gen_ir(ctx, out);
+        Instruction::JZERO(out, out.label+4);
+        Instruction::SUB(out, 0);
+        Instruction::INC(out);
+        Instruction::JUMP(out, out.label+2);
+        Instruction::SUB(out, 0);
     }
 
-    std::vector<Instruction*> LE::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> out;
-        if (! (check_init(left) && check_init(right))) {
-            return out;
+    void LE::gen_ir(Context &ctx, Emitter &out) {
+        if (! (check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
-        auto temp = Minus(left,right,line).gen_ir(cur_label);
-        out.insert(out.end(), temp.begin(), temp.end());
-        Instruction::JPOS(out,(*cur_label)+5,cur_label);
-        Instruction::JZERO(out,(*cur_label)+4,cur_label);
-        Instruction::SUB(out,0, cur_label);
-        Instruction::INC(out, cur_label);
-        Instruction::JUMP(out, (*cur_label)+2, cur_label);
-        Instruction::SUB(out,0, cur_label);
-
-        return out;
+        Minus(left,right,line).gen_ir(ctx, out);
+        Instruction::JPOS(out, out.label+5);
+        Instruction::JZERO(out, out.label+4);
+        Instruction::SUB(out, 0);
+        Instruction::INC(out);
+        Instruction::JUMP(out, out.label+2);
+        Instruction::SUB(out, 0);
     }
 
-    std::vector<Instruction*> GE::gen_ir(int64_t *cur_label) {
-       std::vector<Instruction*> out;
-        if (! (check_init(left) && check_init(right))) {
-            return out;
+    void GE::gen_ir(Context &ctx, Emitter &out) {
+        if (! (check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
-        auto temp = Minus(left,right,line).gen_ir(cur_label);
-        out.insert(out.end(), temp.begin(), temp.end());
-        Instruction::JNEG(out,(*cur_label)+5,cur_label);
-        Instruction::JZERO(out,(*cur_label)+4,cur_label);
-        Instruction::SUB(out,0, cur_label);
-        Instruction::INC(out, cur_label);
-        Instruction::JUMP(out, (*cur_label)+2, cur_label);
-        Instruction::SUB(out,0,cur_label);
-
-        return out;
+        Minus(left,right,line).gen_ir(ctx, out);
+        Instruction::JNEG(out, out.label+5);
+        Instruction::JZERO(out, out.label+4);
+        Instruction::SUB(out, 0);
+        Instruction::INC(out);
+        Instruction::JUMP(out, out.label+2);
+        Instruction::SUB(out, 0);
     }
 
-    std::vector<Instruction*> LEQ::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> out;
-        if (! (check_init(left) && check_init(right))) {
-            return out;
+    void LEQ::gen_ir(Context &ctx, Emitter &out) {
+        if (! (check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
-        auto temp = Minus(left,right,line).gen_ir(cur_label);
-        out.insert(out.end(), temp.begin(), temp.end());
-        Instruction::JPOS(out,(*cur_label)+4,cur_label);
-        Instruction::SUB(out,0, cur_label);
-        Instruction::INC(out, cur_label);
-        Instruction::JUMP(out, (*cur_label)+2, cur_label);
-        Instruction::SUB(out,0,cur_label);
-
-        return out;
+        Minus(left,right,line).gen_ir(ctx, out);
+        Instruction::JPOS(out, out.label+4);
+        Instruction::SUB(out, 0);
+        Instruction::INC(out);
+        Instruction::JUMP(out, out.label+2);
+        Instruction::SUB(out, 0);
     }
 
-    std::vector<Instruction*> GEQ::gen_ir(int64_t *cur_label) {
-        std::vector<Instruction*> out;
-        if (! (check_init(left) && check_init(right))) {
-            return out;
+    void GEQ::gen_ir(Context &ctx, Emitter &out) {
+        if (! (check_init(ctx, left) && check_init(ctx, right))) {
+            return;
         }
-        auto temp = Minus(left,right,line).gen_ir(cur_label);
-        out.insert(out.end(), temp.begin(), temp.end());
-        Instruction::JNEG(out,(*cur_label)+4,cur_label);
-        Instruction::SUB(out,0, cur_label);
-        Instruction::INC(out, cur_label);
-        Instruction::JUMP(out, (*cur_label)+2, cur_label);
-        Instruction::SUB(out,0,cur_label);
-
-        return out;
+        Minus(left,right,line).gen_ir(ctx, out);
+        Instruction::JNEG(out, out.label+4);
+        Instruction::SUB(out, 0);
+        Instruction::INC(out);
+        Instruction::JUMP(out, out.label+2);
+        Instruction::SUB(out, 0);
     }
     
-    std::vector<Instruction*> Var::gen_ir(int64_t *cur_label) {
-        Symbol var = symbols.get_symbol(name);
+    void Var::gen_ir(Context &ctx, Emitter &out) {
+        Symbol &var = ctx.symbols.get_symbol(this);
         if (var.line == Symbol::undef) {
             std::ostringstream os;
             os << "Udeclared var: " << name << std::endl;
-            generator.report(os, line);
-            return std::vector<Instruction*>();
+            ctx.generator.report(os, line);
+            return;
         }
         if (var.is_array) {
             std::ostringstream os;
             os << "Attempt to use array as a variable: " << name << std::endl;
-            generator.report(os, line);
-            return std::vector<Instruction*>();
+            ctx.generator.report(os, line);
+            return;
         }
         
-        std::vector<Instruction*> out;
-        Instruction::LOAD(out, var.offset_id, cur_label);
-        return out;
+        Instruction::LOAD(out, var.offset_id);
     }
 
-    std::vector<Instruction*> ConstArray::gen_ir(int64_t *cur_label) {
+    void ConstArray::gen_ir(Context &ctx, Emitter &out) {
 
-        Symbol arr = symbols.get_symbol(name);
+        Symbol &arr = ctx.symbols.get_symbol(this);
         if (arr.line == Symbol::undef) {
             std::ostringstream os;
             os << "Undeclared variable " << name << ".";
-            generator.report(os, line);
-            return std::vector<Instruction*>();
+            ctx.generator.report(os, line);
+            return;
         }
         if (!arr.is_array) {
             std::ostringstream os;
             os << "Attempt to use a simple variable " << name << " as an array";
-            generator.report(os, line);
-            return std::vector<Instruction*>();
+            ctx.generator.report(os, line);
+            return;
         }
         if (idx < arr.idx_b || idx > arr.idx_a) {
-            std::cout << index_e << "  " << index_b << std::endl;
             std::ostringstream os;
             os << "Attempt to access array " << name
                 << " at index " << idx
                 << "(size: " << arr.size << ").";
-            generator.report(os, line);
-            return std::vector<Instruction*>();
+            ctx.generator.report(os, line);
+            return;
         }
-        std::vector<Instruction*> out;
         int64_t off = arr.offset_id; 
         auto val_off = idx+2 - arr.idx_b;
-        Instruction::LOAD(out, off+val_off, cur_label); 
-
-        return out;
+        Instruction::LOAD(out, off+val_off); 
     }
 
-    std::vector<Instruction*> VarArray::gen_ir(int64_t *cur_label) {
+    void VarArray::gen_ir(Context &ctx, Emitter &out) {
     
 
-        Symbol arr = symbols.get_symbol(name);
+        Symbol &arr = ctx.symbols.get_symbol(this);
         if (arr.line == Symbol::undef) {
             std::ostringstream os;
             os << "Undeclared variable " << name << ".";
-            generator.report(os, line);
-            return std::vector<Instruction*>();
+            ctx.generator.report(os, line);
+            return;
         }
         if (!arr.is_array) {
             std::ostringstream os;
             os << "Attempt to use a simple variable " << name << " as an array";
-            generator.report(os, line);
-            return std::vector<Instruction*>();
+            ctx.generator.report(os, line);
+            return;
         }
         
-        std::vector<Instruction*> out;
-        Instruction::LOAD(out, arr.offset_id, cur_label);
-        Instruction::SUB(out,  arr.offset_id+1, cur_label);
-        Instruction::INC(out, cur_label);
-        Instruction::INC(out, cur_label);
-        Instruction::ADD(out, symbols.get_symbol(index->name).offset_id, cur_label);
-        Instruction::LOADI(out, 0, cur_label);
-
-        return out;
+        Instruction::LOAD(out, arr.offset_id);
+        Instruction::SUB(out, arr.offset_id+1);
+        Instruction::INC(out);
+        Instruction::INC(out);
+        Instruction::ADD(out, ctx.symbols.get_symbol(index).offset_id);
+        Instruction::LOADI(out, 0);
     }
 
 }
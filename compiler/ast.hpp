@@ -2,30 +2,50 @@
 #define AST_H 1
 
 #include <string>
+#include <set>
+#include <unordered_set>
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include "asm.hpp"
 
+class Symbols;
+class Context;
+
 namespace ast {
 
+    class Env;
+    class Liveness;
+    class ValueNumbering;
+    class Var;
+
     class Node {
         public:
         Node(int64_t line) : line(line) {}
         Node() {}
-        //virtual ~Node() = default;
+        virtual ~Node() = default;
         int64_t line;
+
+        // węzły żyją w arenie kontekstu kompilacji (new (ctx) Var(...))
+        // i nie są zwalniane pojedynczo
+        static void *operator new(size_t size, Context &ctx);
+        static void operator delete(void *node, Context &ctx) {}
+        static void operator delete(void *node) {}
         
-        virtual std::vector<Instruction*> gen_ir(int64_t *cur_label) = 0;
+        virtual void gen_ir(Context &ctx, Emitter &out) = 0;
     };
 
     class Identifier : public Node {
         public:
-            std::string name = "";
+            // nazwa z puli Names: równe nazwy mają ten sam wskaźnik
+            const char *name;
             bool array = false;
             bool iter = false;  
             enum Type {N,A,I};
-            Identifier(std::string name, Type type, int64_t line)
+            // numer symbolu nadany przez bind(), generator nie szuka po nazwie
+            static const int64_t unbound = -1;
+            int64_t id = unbound;
+            Identifier(const char *name, Type type, int64_t line)
              : name(name), Node(line) {
                  switch(type) {
                     case A:
@@ -39,30 +59,54 @@ namespace ast {
                 }  
             }
             virtual int type() = 0;
+            void bind(Symbols &symbols);
     };
 
     class Declarations : public Node {
         public:
             std::vector<Identifier*> identifiers;
+            // nazwy potrzebne w kodzie, pozostałe nie dostają pamięci
+            std::unordered_set<const char*> used;
             uint64_t for_counter = 0;
+            // zmienne tymczasowe dla wyrażeń złożonych: _t0, _t1, ...
+            int64_t temporaries = 0;
             void declare(Identifier *identifier);
+            Var *temporary(Context &ctx, int64_t slot, int64_t line);
+            void bind(Symbols &symbols);
             int64_t report_for() {
                 return for_counter++;
             }
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
     };
 
     class Command : public Node {
         public:
             Command(int64_t line) : Node(line) {}
             Command() {}
+
+            // wykonanie w czasie kompilacji, false gdy nie da się go dokończyć
+            virtual bool eval(Env &env) = 0;
+            // żywotność wstecz: z lv.live na wyjściu liczy lv.live na wejściu
+            virtual void live(Liveness &lv) = 0;
+            // eliminacja wspólnych podwyrażeń w przód, przepisuje węzły w miejscu
+            virtual void cse(ValueNumbering &vn) = 0;
+            // przypisanie identyfikatorom numerów symboli przed generacją kodu
+            virtual void bind(Symbols &symbols) = 0;
+            // rodzaj instrukcji w mapie linii
+            virtual Construct construct() = 0;
+            // liczba obrotów znana przed wykonaniem, -1 gdy nieznana
+            virtual int64_t trips() { return -1; }
     };
 
     class Commands : public Node {
-        std::vector<Command*> commands;
         public:
+            std::vector<Command*> commands;
+            bool eval(Env &env);
+            void live(Liveness &lv);
+            void cse(ValueNumbering &vn);
+            void bind(Symbols &symbols);
             void add_command(Command * command);
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
     };
 
     class Program : public Node {
@@ -74,7 +118,7 @@ namespace ast {
             Program(Declarations *declarations, Commands *code)
             : declarations(declarations), code(code) {}
             
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
     };
 
     class Value : public Node {
@@ -86,7 +130,9 @@ namespace ast {
             Value(int64_t val, int64_t line) : value(val), identifier(NULL), Node(line) {}
             Value(Identifier *identifier, int64_t line) : value(-1), identifier(identifier), Node(line),  constI(false) {}
             
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
+            void bind(Symbols &symbols);
     };
 
     class Expression : public Node {
@@ -95,7 +141,11 @@ namespace ast {
         Value *right;
         
         Expression(Value *left, Value *right, int64_t line) : left(left), right(right) {} 
-        virtual std::vector<Instruction*> gen_ir(int64_t *cur_label) = 0;
+        virtual void gen_ir(Context &ctx, Emitter &out) = 0;
+        virtual bool eval(Env &env, int64_t &result) = 0;
+        void bind(Symbols &symbols);
+        // rodzaj wyrażenia w mapie linii, stała należy do przypisania
+        virtual Construct construct() = 0;
     };
 
     class Condition : public Node {
@@ -103,17 +153,28 @@ namespace ast {
         Value *left;
         Value *right;
         Condition(Value *left, Value *right, int64_t line) : left(left), right(right) {}
+        // wynik jak w wygenerowanym kodzie: 1 gdy warunek spełniony, 0 wpp.
+        virtual bool eval(Env &env, int64_t &result) = 0;
+        void bind(Symbols &symbols);
     };
 
     class Assign : public Command {
         public:
             Identifier *identifier;
             Expression *expression;
+            // wynik nigdy nie jest czytany, kod jest sprawdzany ale nie emitowany
+            bool dead = false;
 
             Assign(Identifier *identifier, Expression *expression, int64_t line) 
             : identifier(identifier), expression(expression), Command(line) {}
             
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            void emit(Context &ctx, Emitter &out);
+            bool eval(Env &env);
+            void live(Liveness &lv);
+            void cse(ValueNumbering &vn);
+            void bind(Symbols &symbols);
+            Construct construct() { return Construct::Assign; }
     };
 
     class If : public Command {
@@ -127,7 +188,12 @@ namespace ast {
             If(Condition *condition, Commands *do_then, Commands *do_else, int64_t line)
             : condition(condition), do_then(do_then), do_else(do_else), Command(line) {}
 
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);        
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env);
+            void live(Liveness &lv);
+            void cse(ValueNumbering &vn);
+            void bind(Symbols &symbols);
+            Construct construct() { return Construct::If; }
     };
 
     class While : public Command {
@@ -139,7 +205,12 @@ namespace ast {
             While(Condition *condition, Commands *body, bool reversed, int64_t line)
             : condition(condition), body(body), reversed(reversed), Command(line) {}
 
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env);
+            void live(Liveness &lv);
+            void cse(ValueNumbering &vn);
+            void bind(Symbols &symbols);
+            Construct construct() { return Construct::While; }
     };
 
     class For : public Command {
@@ -155,7 +226,13 @@ namespace ast {
             For(Identifier *iterator, Value *from, Value *to, Commands *body, bool reversed, int64_t line, int64_t id)
             : iterator(iterator), from(from), to(to),body(body), reversed(reversed), Command(line), id(id) {}
 
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env);
+            void live(Liveness &lv);
+            void cse(ValueNumbering &vn);
+            void bind(Symbols &symbols);
+            Construct construct() { return Construct::For; }
+            int64_t trips();
     };
 
     class Read : public Command {
@@ -165,7 +242,12 @@ namespace ast {
             Read(Identifier *identifier, int64_t line) 
             : identifier(identifier), Command(line) {}
 
-            std::vector<Instruction*> gen_ir(int64_t *cur_label); 
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env);
+            void live(Liveness &lv);
+            void cse(ValueNumbering &vn);
+            void bind(Symbols &symbols);
+            Construct construct() { return Construct::Read; }
     };
 
     class Write : public Command {
@@ -175,7 +257,12 @@ namespace ast {
             Write(Value *value, int64_t line)
             : value(value), Command(line) {}
 
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env);
+            void live(Liveness &lv);
+            void cse(ValueNumbering &vn);
+            void bind(Symbols &symbols);
+            Construct construct() { return Construct::Write; }
     };
 
     class Const : public Expression {
@@ -183,81 +270,99 @@ namespace ast {
             Const(Value *value, int64_t line) 
             : Expression(value, NULL, line) {}
 
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
+            Construct construct() { return Construct::Assign; }
     };   
 
     class Plus : public Expression {
         public:
             Plus(Value *left, Value *right, int64_t line) : Expression(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
+            Construct construct() { return Construct::Plus; }
     };
 
     class Minus : public Expression {
         public:
             Minus(Value *left, Value *right, int64_t line) : Expression(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
+            Construct construct() { return Construct::Minus; }
     };
 
     class Times : public Expression {
         public:
             Times(Value *left, Value *right, int64_t line) : Expression(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
+            Construct construct() { return Construct::Times; }
     };
 
     class Div : public Expression {
         public:
             Div(Value *left, Value *right, int64_t line) : Expression(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
+            Construct construct() { return Construct::Div; }
     };
 
     class Mod : public Expression {
         public:
             Mod(Value *left, Value *right, int64_t line) : Expression(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
+            Construct construct() { return Construct::Mod; }
     };
 
     class EQ : public Condition {
         public:
             EQ(Value *left, Value *right, int64_t line) : Condition(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
     };
 
      class NEQ : public Condition {
         public:
             NEQ(Value *left, Value *right, int64_t line) : Condition(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
     };
 
      class LE : public Condition {
         public:
             LE(Value *left, Value *right, int64_t line) : Condition(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
     };
 
      class GE : public Condition {
         public:
             GE(Value *left, Value *right, int64_t line) : Condition(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
     };
 
      class LEQ : public Condition {
         public:
             LEQ(Value *left, Value *right, int64_t line) : Condition(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
     };
 
      class GEQ : public Condition {
         public:
             GEQ(Value *left, Value *right, int64_t line) : Condition(left, right, line) {}
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            bool eval(Env &env, int64_t &result);
     };
 
     class Var : public Identifier {
         public:
-            Var(std::string name, int64_t line) : Identifier(name, N, line) {}
-            Var(std::string name, Type type, int line) : Identifier(name, type, line) {}
+            Var(const char *name, int64_t line) : Identifier(name, N, line) {}
+            Var(const char *name, Type type, int line) : Identifier(name, type, line) {}
             
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
             int type() {return 0;}
     };
 
@@ -265,13 +370,13 @@ namespace ast {
         public:
             int64_t index_b, index_e;
             int64_t idx;
-            ConstArray(std::string name, int64_t index, int64_t line)
+            ConstArray(const char *name, int64_t index, int64_t line)
             : Identifier(name, A, line), idx(index) {}
-            ConstArray(std::string name, int64_t index_b, int64_t index_e, int64_t line)
+            ConstArray(const char *name, int64_t index_b, int64_t index_e, int64_t line)
             : Identifier(name, A, line), index_b(index_b), index_e(index_e){}
             
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
-            std::vector<Instruction*> assign_to_var(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            void assign_to_var(Context &ctx, Emitter &out);
             int type() {return 1;}
     };
 
@@ -279,13 +384,42 @@ namespace ast {
         public:
             Var *index;
            
-            VarArray(std::string name, Var *index, int64_t line)
+            VarArray(const char *name, Var *index, int64_t line)
             : Identifier(name, A, line), index(index) {}
             
-            std::vector<Instruction*> gen_ir(int64_t *cur_label);
-            std::vector<Instruction*> assign_to_var(int64_t *cur_label);
+            void gen_ir(Context &ctx, Emitter &out);
+            void assign_to_var(Context &ctx, Emitter &out);
             int type() {return 2;}
     };
 
+    // Wyrażenie z wieloma operatorami prosto z parsera. Przed budową AST jest
+    // rozbijane na przypisania do zmiennych tymczasowych, w kolejności
+    // Sethiego–Ullmana (najpierw poddrzewo potrzebujące więcej komórek).
+    class ExprTree {
+        public:
+            enum Op {LEAF, PLUS, MINUS, TIMES, DIV, MOD};
+            Op op;
+            Value *value;
+            ExprTree *left, *right;
+            int64_t line;
+
+            ExprTree(Value *value, int64_t line)
+            : op(LEAF), value(value), left(NULL), right(NULL), line(line) {}
+            ExprTree(Op op, ExprTree *left, ExprTree *right, int64_t line)
+            : op(op), value(NULL), left(left), right(right), line(line) {}
+            static void *operator new(size_t size, Context &ctx);
+            static void operator delete(void *tree, Context &ctx) {}
+            static void operator delete(void *tree) {}
+
+            // liczba zmiennych tymczasowych potrzebna do policzenia poddrzewa
+            int64_t need();
+            // przypisania pomocnicze trafiają do ctx.prelude, zmienne tymczasowe
+            // do ctx.decls, zwraca końcowe przypisanie
+            Assign *lower(Context &ctx, Identifier *target);
+        private:
+            Expression *operation(Context &ctx, int64_t slot);
+            Value *operand(Context &ctx, int64_t slot);
+    };
+
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "batch.hpp"
+#include "compile.hpp"
+#include "pool.hpp"
+
+struct Job {
+    std::string input, output;
+    int status = 0;
+    double ms = 0;
+    std::string log;
+};
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool read_manifest(const char *manifest, std::vector<Job> &jobs) {
+    std::ifstream file(manifest);
+    if (!file) {
+        std::cerr << "No such file: " << manifest << std::endl;
+        return false;
+    }
+    std::string text;
+    for (int number = 1; std::getline(file, text); number++) {
+        text = text.substr(0, text.find('#'));
+        std::istringstream fields(text);
+        Job job;
+        if (!(fields >> job.input)) {
+            continue;
+        }
+        std::string rest;
+        if (!(fields >> job.output) || fields >> rest) {
+            std::cerr << manifest << ":" << number << ": expected \"input output\"" << std::endl;
+            return false;
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+int run_batch(const char *manifest, int threads, const Options &options) {
+    std::vector<Job> jobs;
+    if (!read_manifest(manifest, jobs)) {
+        return 1;
+    }
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max(1, std::min<int>(threads, jobs.size()));
+
+    std::vector<std::function<void()>> tasks;
+    for (Job &job : jobs) {
+        Job *j = &job;
+        tasks.push_back([j, &options] {
+            auto start = std::chrono::steady_clock::now();
+            std::ostringstream log;
+            {
+                Context ctx(log);
+                ctx.options = options;
+                j->status = compile(ctx, j->input.c_str(), j->output.c_str());
+            }
+            j->ms = since(start);
+            j->log = log.str();
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    WorkPool(threads).run(tasks);
+    double wall = since(start);
+
+    // wyniki w kolejności manifestu, log tylko dla plików z błędem albo
+    // gdy zawiera raport czasów
+    int failed = 0;
+    double total = 0;
+    const Job *slowest = NULL;
+    std::cerr << std::fixed << std::setprecision(2);
+    for (const Job &job : jobs) {
+        total += job.ms;
+        if (!slowest || job.ms > slowest->ms) {
+            slowest = &job;
+        }
+        if (job.status == 0) {
+            std::cerr << "[ok]   " << job.input << " -> " << job.output << "  " << job.ms << " ms" << std::endl;
+            if (!options.reports()) {
+                continue;
+            }
+        } else {
+            failed++;
+            std::cerr << "[FAIL] " << job.input << "  " << job.ms << " ms" << std::endl;
+        }
+        std::istringstream lines(job.log);
+        std::string text;
+        while (std::getline(lines, text)) {
+            std::cerr << "       " << text << std::endl;
+        }
+    }
+    std::cerr << "Batch: " << jobs.size() << " files, " << jobs.size() - failed << " compiled, "
+        << failed << " failed, " << threads << " threads" << std::endl;
+    std::cerr << "Wall time: " << wall << " ms, compile time: " << total << " ms (sum), "
+        << (wall > 0 ? total / wall : 0) << "x parallel" << std::endl;
+    if (slowest) {
+        std::cerr << "Slowest: " << slowest->input << " " << slowest->ms << " ms" << std::endl;
+    }
+    return failed > 0;
+}
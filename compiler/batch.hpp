@@ -0,0 +1,12 @@
+#ifndef BATCH_H
+#define BATCH_H 1
+
+#include "options.hpp"
+
+// Tryb wsadowy: kompiluje wiele par "wejście wyjście" (po jednej w linii
+// manifestu, # zaczyna komentarz) w jednym procesie na puli jobs wątków.
+// Każdy plik ma własny kontekst i własny log, błąd jednego nie przerywa
+// pozostałych. Na końcu wypisuje wynik każdego pliku i podsumowanie czasów.
+// jobs == 0 oznacza liczbę rdzeni. Zwraca 0 gdy wszystkie pliki się udały.
+int run_batch(const char *manifest, int jobs, const Options &options);
+#endif
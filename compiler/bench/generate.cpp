@@ -0,0 +1,188 @@
+// Generator syntetycznych programów do pomiaru przepustowości kompilatora.
+// Osie: liczba instrukcji, głębokość zagnieżdżenia, liczba zmiennych
+// i tablic, udział TIMES/DIV/MOD wśród wyrażeń. Wszystkie zmienne są na
+// początku czytane przez READ (poza licznikiem instrukcji, żeby oś zmiennych
+// nie zjadała instrukcji), więc ewaluacja częściowa nie zwija programu,
+// a generator kodu pracuje na pełnym drzewie. Wynik jest deterministyczny
+// dla danego ziarna.
+// Użycie: genprog [-n instrukcje] [-d głębokość] [-v zmienne] [-a tablice]
+//                 [-m udział mnożeń 0..1] [-s ziarno] > program.imp
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+static const int64_t array_size = 16;
+
+struct Generator {
+    int64_t statements = 100000;
+    int depth = 4;
+    int variables = 26;
+    int arrays = 2;
+    double density = 0.3;
+    std::mt19937_64 random;
+
+    int64_t emitted = 0;
+    std::string out;
+
+    // nazwy tylko z małych liter: przedrostek i numer zapisany literami
+    static std::string name(char prefix, int64_t number) {
+        std::string text(1, prefix);
+        do {
+            text += (char)('a' + number % 26);
+            number /= 26;
+        } while (number > 0);
+        return text;
+    }
+
+    int64_t below(int64_t limit) {
+        return random() % limit;
+    }
+
+    void flush() {
+        if (out.size() > (1 << 20)) {
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            out.clear();
+        }
+    }
+
+    std::string value() {
+        int64_t choice = below(10);
+        if (choice < 2) {
+            return std::to_string(below(1000) + 1);
+        }
+        if (arrays > 0 && choice < 4) {
+            std::string array = name('t', below(arrays));
+            if (choice == 2) {
+                return array + "(" + std::to_string(below(array_size)) + ")";
+            }
+            return array + "(" + name('v', below(variables)) + ")";
+        }
+        return name('v', below(variables));
+    }
+
+    std::string target() {
+        if (arrays > 0 && below(4) == 0) {
+            return name('t', below(arrays)) + "(" + std::to_string(below(array_size)) + ")";
+        }
+        return name('v', below(variables));
+    }
+
+    void assignment() {
+        static const char *const heavy[] = {"TIMES", "DIV", "MOD"};
+        static const char *const light[] = {"PLUS", "MINUS"};
+        const char *op = std::uniform_real_distribution<double>(0, 1)(random) < density
+            ? heavy[below(3)] : light[below(2)];
+        out += target() + " ASSIGN " + value() + " " + op + " " + value() + ";\n";
+        emitted++;
+    }
+
+    std::string condition() {
+        static const char *const relations[] = {"EQ", "NEQ", "LE", "GE", "LEQ", "GEQ"};
+        return value() + " " + relations[below(6)] + " " + value();
+    }
+
+    // jedno zagnieżdżenie: na każdym poziomie kilka przypisań i poziom niżej,
+    // rodzaj bloku zmienia się z poziomem (IF, FOR, WHILE)
+    void nest(int level) {
+        int body = 2 + below(3);
+        if (level == depth) {
+            for (int i = 0; i < body; i++) {
+                assignment();
+            }
+            return;
+        }
+        emitted++;
+        switch (level % 3) {
+            case 0:
+                out += "IF " + condition() + " THEN\n";
+                break;
+            case 1:
+                out += "FOR " + name('i', level) + " FROM 1 TO " + value() + " DO\n";
+                break;
+            case 2:
+                out += name('w', level) + " ASSIGN 0;\nWHILE " + name('w', level) + " LE 3 DO\n";
+                break;
+        }
+        for (int i = 0; i < body / 2; i++) {
+            assignment();
+        }
+        nest(level + 1);
+        for (int i = body / 2; i < body; i++) {
+            assignment();
+        }
+        switch (level % 3) {
+            case 0:
+                out += "ELSE\n";
+                assignment();
+                out += "ENDIF\n";
+                break;
+            case 1:
+                out += "ENDFOR\n";
+                break;
+            case 2:
+                out += name('w', level) + " ASSIGN " + name('w', level) + " PLUS 1;\nENDWHILE\n";
+                break;
+        }
+    }
+
+    void program() {
+        out += "DECLARE\n";
+        for (int i = 0; i < variables; i++) {
+            out += name('v', i) + ", ";
+        }
+        for (int i = 0; i < depth; i++) {
+            out += name('w', i) + ", ";
+        }
+        for (int i = 0; i < arrays; i++) {
+            out += name('t', i) + "(0:" + std::to_string(array_size - 1) + "), ";
+        }
+        out += "sum\nBEGIN\n";
+        for (int i = 0; i < variables; i++) {
+            out += "READ " + name('v', i) + ";\n";
+        }
+        for (int i = 0; i < arrays; i++) {
+            out += "FOR ix FROM 0 TO " + std::to_string(array_size - 1) + " DO READ " + name('t', i) + "(ix); ENDFOR\n";
+        }
+        while (emitted < statements) {
+            if (depth == 0) {
+                assignment();
+            } else {
+                nest(0);
+            }
+            flush();
+        }
+        out += "sum ASSIGN " + name('v', 0) + " PLUS " + name('v', variables - 1) + ";\nWRITE sum;\nEND\n";
+        std::fwrite(out.data(), 1, out.size(), stdout);
+    }
+};
+
+int main(int argc, char *argv[]) {
+    Generator generator;
+    uint64_t seed = 2020;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *flag = argv[i];
+        const char *arg = argv[i + 1];
+        if (std::strcmp(flag, "-n") == 0) {
+            generator.statements = std::atoll(arg);
+        } else if (std::strcmp(flag, "-d") == 0) {
+            generator.depth = std::atoi(arg);
+        } else if (std::strcmp(flag, "-v") == 0) {
+            generator.variables = std::max(1, std::atoi(arg));
+        } else if (std::strcmp(flag, "-a") == 0) {
+            generator.arrays = std::atoi(arg);
+        } else if (std::strcmp(flag, "-m") == 0) {
+            generator.density = std::atof(arg);
+        } else if (std::strcmp(flag, "-s") == 0) {
+            seed = std::strtoull(arg, NULL, 10);
+        } else {
+            std::fprintf(stderr, "unknown option: %s\n", flag);
+            return 1;
+        }
+    }
+    generator.random.seed(seed);
+    generator.program();
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Przepustowość samego lexera w MB/s: plik jest skanowany do końca przez
+// yylex(), raz przez FILE* (bufory flexa) i raz zmapowany w pamięć.
+// Użycie: lexbench plik [powtórzenia]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "ast.hpp"
+#include "context.hpp"
+#include "grammar.tab.h"
+
+// najlepszy czas z kilku przebiegów, zwraca liczbę tokenów
+double run(const char *path, bool mapped, int repeat, int64_t &tokens) {
+    double best = 0;
+    for (int r = 0; r < repeat; r++) {
+        auto start = std::chrono::steady_clock::now();
+        Context ctx;
+        FILE *file = NULL;
+        if (mapped) {
+            if (!scan_mapped(ctx, path)) {
+                std::fprintf(stderr, "mmap failed: %s\n", path);
+                std::exit(1);
+            }
+        } else {
+            file = std::fopen(path, "r");
+            if (!file) {
+                std::fprintf(stderr, "No such file: %s\n", path);
+                std::exit(1);
+            }
+            scan_file(ctx, file);
+        }
+        YYSTYPE value;
+        tokens = 0;
+        while (yylex(&value, ctx.scanner)) {
+            tokens++;
+        }
+        scan_release(ctx);
+        if (file) {
+            std::fclose(file);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s file [repeat]\n", argv[0]);
+        return 1;
+    }
+    int repeat = argc > 2 ? std::atoi(argv[2]) : 5;
+    struct stat st;
+    if (stat(argv[1], &st) < 0) {
+        std::fprintf(stderr, "No such file: %s\n", argv[1]);
+        return 1;
+    }
+    double mb = st.st_size / 1e6;
+    for (bool mapped : {false, true}) {
+        int64_t tokens;
+        double seconds = run(argv[1], mapped, repeat, tokens);
+        std::printf("%-6s %10.1f %10lld %10.1f\n", mapped ? "mmap" : "file", mb, (long long)tokens, mb / seconds);
+    }
+    return 0;
+}
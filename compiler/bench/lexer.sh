@@ -0,0 +1,30 @@
+#!/bin/sh
+# Przepustowość lexera (MB/s) na syntetycznych programach różnej wielkości,
+# wejście przez FILE* i zmapowane w pamięć.
+# Użycie: bench/lexer.sh [lexbench]   (domyślnie binary/lexbench)
+
+LEXBENCH=${1:-./binary/lexbench}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# program(mb): przypisania, warunki, pętle i komentarze aż do mb megabajtów
+program() {
+    awk -v limit=$(($1 * 1000000)) 'BEGIN {
+        print "DECLARE alpha, beta, gamma, t(0:99) BEGIN READ alpha; READ beta;"
+        size = 0; i = 0
+        while (size < limit) {
+            s = sprintf("gamma ASSIGN alpha PLUS %d; [krok %d] t(%d) ASSIGN gamma TIMES beta;\n", i, i, i % 100)
+            s = s sprintf("IF gamma GEQ -%d THEN beta ASSIGN beta MINUS 1; ELSE WRITE t(%d); ENDIF\n", i, i % 100)
+            s = s "FOR iter FROM alpha TO beta DO alpha ASSIGN alpha MOD iter; ENDFOR\n"
+            printf "%s", s
+            size += length(s); i++
+        }
+        print "WRITE gamma; END"
+    }'
+}
+
+printf "%-6s %10s %10s %10s\n" input MB tokens MB/s
+for mb in 1 4 16 64; do
+    program $mb > "$WORK/in.imp"
+    "$LEXBENCH" "$WORK/in.imp" || { echo "lexbench failed: $mb MB"; exit 1; }
+done
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Czas kompilacji programów z coraz głębiej zagnieżdżonymi IF i WHILE.
+# Przy liniowym generatorze czas na poziom (ostatnia kolumna) jest stały.
+# Użycie: bench/nesting.sh [kompilator]   (domyślnie binary/kompilator)
+
+COMPILER=${1:-./binary/kompilator}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# program(kind, depth): kind to "if" albo "while"
+program() {
+    echo "DECLARE a, b BEGIN READ a; b ASSIGN 0;"
+    i=1
+    while [ $i -le $2 ]; do
+        if [ "$1" = if ]; then
+            echo "IF a GE $i THEN b ASSIGN b PLUS 1;"
+        else
+            echo "WHILE a GE $i DO a ASSIGN a MINUS 1;"
+        fi
+        i=$((i + 1))
+    done
+    i=1
+    while [ $i -le $2 ]; do
+        if [ "$1" = if ]; then echo "ENDIF"; else echo "ENDWHILE"; fi
+        i=$((i + 1))
+    done
+    echo "WRITE b; WRITE a; END"
+}
+
+printf "%-6s %6s %10s %12s\n" kind depth ms us/level
+for kind in if while; do
+    for depth in 250 500 1000 2000; do
+        program $kind $depth > "$WORK/in.imp"
+        start=$(date +%s%N)
+        "$COMPILER" "$WORK/in.imp" "$WORK/out.s" > /dev/null 2>&1 || { echo "compilation failed: $kind $depth"; exit 1; }
+        end=$(date +%s%N)
+        ns=$((end - start))
+        printf "%-6s %6d %10d %12d\n" $kind $depth $((ns / 1000000)) $((ns / 1000 / depth))
+    done
+done
@@ -0,0 +1,62 @@
+#!/bin/sh
+# Czas kompilacji i pamięć na syntetycznych programach (bench/generate.cpp)
+# skalowanych po kolei wzdłuż osi: liczba instrukcji, głębokość
+# zagnieżdżenia, liczba zmiennych, liczba tablic, udział TIMES/DIV/MOD.
+# Pomiar pochodzi z --time-report=json (czas wszystkich faz, alokacje,
+# szczytowe RSS). Ostatnia kolumna to czas na instrukcję; przy liniowym
+# generatorze jest stała wzdłuż osi instrukcji.
+# Użycie: bench/throughput.sh [kompilator] [genprog]
+#   MAX_STATEMENTS=7  oś instrukcji do 10^7 (domyślnie 10^6; ~3.5 GB RSS przy 10^6)
+#   TIMEOUT=sekundy   limit na jedną kompilację (domyślnie 300)
+#   RESULTS=plik      dopisuje wyniki w formacie TSV
+
+COMPILER=${1:-./binary/kompilator}
+GENPROG=${2:-./binary/genprog}
+MAX=${MAX_STATEMENTS:-6}
+LIMIT=${TIMEOUT:-300}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# run(oś, wartość, opcje genprog...)
+run() {
+    axis=$1
+    value=$2
+    shift 2
+    "$GENPROG" "$@" > "$WORK/in.imp"
+    statements=$(printf '%s ' "$@" | sed -n 's/.*-n \([0-9]*\).*/\1/p')
+    mb=$(wc -c < "$WORK/in.imp" | awk '{ printf "%.1f", $1 / 1e6 }')
+    report=$(timeout "$LIMIT" "$COMPILER" --time-report=json "$WORK/in.imp" "$WORK/out.s" 2>&1 | grep '^{')
+    if [ -z "$report" ]; then
+        printf "%-12s %8s %10s %8s %10s\n" "$axis" "$value" "$statements" "$mb" "failed/timeout"
+        return
+    fi
+    echo "$report" | sed 's/.*"total": {"wall_ms": \([0-9.]*\), "allocations": \([0-9]*\), "peak_rss_kb": \([0-9]*\)}}/\1 \2 \3/' |
+        awk -v axis="$axis" -v value="$value" -v n="$statements" -v mb="$mb" -v results="$RESULTS" '{
+            printf "%-12s %8s %10s %8s %10.1f %12d %9.1f %9.2f\n", axis, value, n, mb, $1, $2, $3 / 1024, $1 * 1000 / n
+            if (results != "") {
+                printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\n", axis, value, n, mb, $1, $2, $3 >> results
+            }
+        }'
+}
+
+printf "%-12s %8s %10s %8s %10s %12s %9s %9s\n" axis value statements MB "wall ms" allocations "peak MB" "us/stmt"
+exp=3
+n=1000
+while [ $exp -le "$MAX" ]; do
+    run statements "10^$exp" -n $n
+    exp=$((exp + 1))
+    n=$((n * 10))
+done
+# głębokość rośnie ostrożnie: czas generacji zależy od niej mocno
+for d in 0 1 2 4 8 12 16; do
+    run depth $d -n 10000 -d $d
+done
+for v in 10 100 1000 10000; do
+    run variables $v -n 10000 -v $v
+done
+for a in 0 1 10 100; do
+    run arrays $a -n 10000 -a $a
+done
+for m in 0 0.25 0.5 0.75 1; do
+    run density $m -n 10000 -m $m
+done
@@ -0,0 +1,89 @@
+// Wypisywanie wygenerowanego kodu: operator<< dla każdego rozkazu do
+// std::ofstream kontra AsmWriter (jeden bufor, jeden write). Rozkazy są
+// losowe, z rozkładem argumentów podobnym do prawdziwych programów (małe
+// adresy komórek, skoki do kilku milionów). Sprawdza też, że oba pliki są
+// identyczne. Użycie: writebench [miliony rozkazów] [powtórzenia]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "asm.hpp"
+#include "writer.hpp"
+
+static std::vector<Instruction> program(size_t size) {
+    std::mt19937_64 random(2020);
+    std::vector<Instruction> code;
+    code.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        ASM command = (ASM)(random() % ((int)ASM::HALT + 1));
+        Instruction instruction(command);
+        if (instruction.is_jump()) {
+            instruction.arg = random() % size;
+        } else if (instruction.is_memory()) {
+            instruction.arg = random() % 1000;
+        }
+        code.push_back(instruction);
+    }
+    return code;
+}
+
+static std::string read_file(const char *path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+template<class Write> static double best(int repeat, Write write) {
+    double result = 0;
+    for (int r = 0; r < repeat; r++) {
+        auto start = std::chrono::steady_clock::now();
+        write();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || seconds < result) {
+            result = seconds;
+        }
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    double millions = argc > 1 ? std::atof(argv[1]) : 1;
+    int repeat = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::vector<Instruction> code = program(millions * 1e6);
+    char stream_path[] = "/tmp/writebench-stream-XXXXXX";
+    char writer_path[] = "/tmp/writebench-writer-XXXXXX";
+    close(mkstemp(stream_path));
+    close(mkstemp(writer_path));
+
+    double stream = best(repeat, [&]() {
+        std::ofstream file(stream_path);
+        for (const Instruction &instruction : code) {
+            file << instruction;
+        }
+    });
+    double writer = best(repeat, [&]() {
+        int file = open(writer_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        AsmWriter out;
+        out.format(code);
+        out.write_to(file);
+        close(file);
+    });
+
+    std::string expected = read_file(stream_path);
+    bool same = expected == read_file(writer_path);
+    unlink(stream_path);
+    unlink(writer_path);
+    std::printf("%-8s %10s %10s %10s\n", "output", "MB", "seconds", "MB/s");
+    std::printf("%-8s %10.1f %10.3f %10.1f\n", "ostream", expected.size() / 1e6, stream, expected.size() / 1e6 / stream);
+    std::printf("%-8s %10.1f %10.3f %10.1f\n", "writer", expected.size() / 1e6, writer, expected.size() / 1e6 / writer);
+    std::printf("speedup %.2fx\n", stream / writer);
+    if (!same) {
+        std::printf("outputs differ\n");
+        return 1;
+    }
+    return 0;
+}
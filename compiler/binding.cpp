@@ -0,0 +1,77 @@
+#include "ast.hpp"
+#include "symbols.hpp"
+
+namespace ast {
+
+    // Każda nazwa jest haszowana raz; generator kodu sięga potem do tablicy
+    // symboli przez Identifier::id zamiast szukać po napisie.
+    void Identifier::bind(Symbols &symbols) {
+        symbols.bind(this);
+        if (type() == 2) {
+            symbols.bind(((VarArray*)this)->index);
+        }
+    }
+
+    void Declarations::bind(Symbols &symbols) {
+        for (Identifier *identifier : identifiers) {
+            identifier->bind(symbols);
+        }
+    }
+
+    void Commands::bind(Symbols &symbols) {
+        for (Command *cmd : commands) {
+            cmd->bind(symbols);
+        }
+    }
+
+    void Value::bind(Symbols &symbols) {
+        if (!is_const()) {
+            identifier->bind(symbols);
+        }
+    }
+
+    void Expression::bind(Symbols &symbols) {
+        left->bind(symbols);
+        if (right) {
+            right->bind(symbols);
+        }
+    }
+
+    void Condition::bind(Symbols &symbols) {
+        left->bind(symbols);
+        right->bind(symbols);
+    }
+
+    void Assign::bind(Symbols &symbols) {
+        identifier->bind(symbols);
+        expression->bind(symbols);
+    }
+
+    void If::bind(Symbols &symbols) {
+        condition->bind(symbols);
+        do_then->bind(symbols);
+        if (do_else) {
+            do_else->bind(symbols);
+        }
+    }
+
+    void While::bind(Symbols &symbols) {
+        condition->bind(symbols);
+        body->bind(symbols);
+    }
+
+    void For::bind(Symbols &symbols) {
+        iterator->bind(symbols);
+        from->bind(symbols);
+        to->bind(symbols);
+        body->bind(symbols);
+    }
+
+    void Read::bind(Symbols &symbols) {
+        identifier->bind(symbols);
+    }
+
+    void Write::bind(Symbols &symbols) {
+        value->bind(symbols);
+    }
+}
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cache.hpp"
+#include "compile.hpp"
+#include "protocol.hpp"
+
+// wersja wyniku w kluczu: podbijana przy każdej zmianie generowanego kodu,
+// komunikatów albo formatu wpisu (jak object::version dla plików .kob)
+static const char *version = "kompilator 1";
+static const char magic[8] = {'K', 'C', 'A', 'C', 'H', 'E', '1', '\n'};
+
+// FNV-1a, jak w Names
+static uint64_t hash(const std::string &text) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::string cache_key(const std::vector<char> &source, const std::string &options) {
+    std::string key(version);
+    key += '\0';
+    key += options;
+    key += '\0';
+    key.append(source.data(), source.size());
+    return key;
+}
+
+CompileCache::CompileCache(const std::string &dir, uint64_t limit) : dir(dir), limit(limit) {
+    mkdir(dir.c_str(), 0777);
+}
+
+bool CompileCache::configured(std::string &dir, uint64_t &limit) {
+    const char *path = std::getenv("KOMPILATOR_CACHE");
+    if (!path || !*path) {
+        return false;
+    }
+    dir = path;
+    limit = 256;
+    const char *megabytes = std::getenv("KOMPILATOR_CACHE_LIMIT");
+    if (megabytes) {
+        limit = std::strtoull(megabytes, NULL, 10);
+    }
+    limit <<= 20;
+    return true;
+}
+
+std::string CompileCache::path(const std::string &key) {
+    std::ostringstream name;
+    name << dir << '/' << std::hex << std::setw(16) << std::setfill('0') << hash(key) << ".kc";
+    return name.str();
+}
+
+static bool read_string(int fd, std::string &text) {
+    std::vector<char> block;
+    if (!protocol::read_block(fd, block)) {
+        return false;
+    }
+    text.assign(block.begin(), block.end());
+    return true;
+}
+
+bool CompileCache::lookup(const std::string &key, Entry &entry) {
+    std::string file = path(key);
+    int fd = open(file.c_str(), O_RDONLY);
+    bool hit = false;
+    if (fd >= 0) {
+        char header[sizeof(magic)];
+        std::string stored;
+        uint8_t written;
+        hit = protocol::read_all(fd, header, sizeof(header)) && std::memcmp(header, magic, sizeof(magic)) == 0
+            && read_string(fd, stored) && stored == key
+            && protocol::read_all(fd, &entry.status, sizeof(entry.status))
+            && protocol::read_all(fd, &written, sizeof(written))
+            && read_string(fd, entry.code) && read_string(fd, entry.log);
+        entry.written = written;
+        close(fd);
+    }
+    if (hit) {
+        // świeży czas modyfikacji odsuwa wpis od usunięcia
+        utimensat(AT_FDCWD, file.c_str(), NULL, 0);
+    }
+    update([hit](Stats &stats) { (hit ? stats.hits : stats.misses)++; });
+    return hit;
+}
+
+void CompileCache::store(const std::string &key, const Entry &entry) {
+    std::string file = path(key);
+    std::ostringstream temporary;
+    temporary << file << '.' << getpid() << ".tmp";
+    int fd = open(temporary.str().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        return;
+    }
+    uint8_t written = entry.written;
+    bool saved = protocol::write_all(fd, magic, sizeof(magic))
+        && protocol::write_block(fd, key.data(), key.size())
+        && protocol::write_all(fd, &entry.status, sizeof(entry.status))
+        && protocol::write_all(fd, &written, sizeof(written))
+        && protocol::write_block(fd, entry.code.data(), entry.code.size())
+        && protocol::write_block(fd, entry.log.data(), entry.log.size());
+    close(fd);
+    // nadpisany wpis (kolizja albo wyścig dwóch procesów) nie zwalnia miejsca
+    // w liczniku, co najwyżej przyspiesza usuwanie, które liczy od nowa
+    struct stat st;
+    if (!saved || stat(temporary.str().c_str(), &st) < 0 || rename(temporary.str().c_str(), file.c_str()) < 0) {
+        unlink(temporary.str().c_str());
+        return;
+    }
+    uint64_t size = st.st_size;
+    update([this, size](Stats &stats) {
+        stats.stores++;
+        stats.bytes += size;
+        if (stats.bytes > limit) {
+            evict(stats);
+        }
+    });
+}
+
+template<class Update> void CompileCache::update(Update change) {
+    std::string lock = dir + "/stats";
+    int fd = open(lock.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        return;
+    }
+    flock(fd, LOCK_EX);
+    Stats stats;
+    if (!protocol::read_all(fd, &stats, sizeof(stats))) {
+        stats = Stats();
+    }
+    change(stats);
+    if (lseek(fd, 0, SEEK_SET) == 0) {
+        protocol::write_all(fd, &stats, sizeof(stats));
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+// usuwa najdawniej używane wpisy do zejścia poniżej limitu i liczy rozmiar od nowa
+void CompileCache::evict(Stats &stats) {
+    struct File {
+        std::string path;
+        uint64_t size;
+        struct timespec used;
+    };
+    std::vector<File> files;
+    DIR *listing = opendir(dir.c_str());
+    if (!listing) {
+        return;
+    }
+    while (dirent *item = readdir(listing)) {
+        std::string name = item->d_name;
+        struct stat st;
+        std::string file = dir + '/' + name;
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, ".kc") == 0 && stat(file.c_str(), &st) == 0) {
+            files.push_back({file, (uint64_t)st.st_size, st.st_mtim});
+        }
+    }
+    closedir(listing);
+    std::sort(files.begin(), files.end(), [](const File &a, const File &b) {
+        return a.used.tv_sec != b.used.tv_sec ? a.used.tv_sec < b.used.tv_sec : a.used.tv_nsec < b.used.tv_nsec;
+    });
+    stats.bytes = 0;
+    for (File &file : files) {
+        stats.bytes += file.size;
+    }
+    for (File &file : files) {
+        if (stats.bytes <= limit) {
+            break;
+        }
+        if (unlink(file.path.c_str()) == 0) {
+            stats.bytes -= file.size;
+            stats.evictions++;
+        }
+    }
+}
+
+CompileCache::Stats CompileCache::stats() {
+    Stats result;
+    update([&result](Stats &stats) { result = stats; });
+    return result;
+}
+
+void CompileCache::print_stats(std::ostream &out) {
+    Stats s = stats();
+    uint64_t lookups = s.hits + s.misses;
+    out << "Cache " << dir << "\n"
+        << "  hits " << s.hits << ", misses " << s.misses;
+    if (lookups > 0) {
+        out << " (" << std::fixed << std::setprecision(1) << 100.0 * s.hits / lookups << "% hit rate)";
+    }
+    out << "\n  stored " << s.stores << ", evicted " << s.evictions << "\n"
+        << "  size " << s.bytes / 1024 << " KB of " << limit / 1024 << " KB" << std::endl;
+}
+
+int compile_cached(CompileCache &cache, const char *input, const char *output, const Options &options) {
+    std::ifstream file(input, std::ios::binary);
+    if (!file) {
+        std::cerr << "No such file: " << input << std::endl;
+        return 1;
+    }
+    std::vector<char> source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string key = cache_key(source, options.key());
+    CompileCache::Entry entry;
+    if (!cache.lookup(key, entry)) {
+        std::ostringstream log, code;
+        Context ctx(log);
+        ctx.options = options;
+        entry.status = compile(ctx, source, code, entry.written);
+        entry.code = code.str();
+        entry.log = log.str();
+        cache.store(key, entry);
+    }
+    std::cerr << entry.log;
+    if (entry.written) {
+        std::ofstream result(output, std::ios::binary);
+        result.write(entry.code.data(), entry.code.size());
+        result.close();
+        if (!result) {
+            std::cerr << "Cannot write " << output << std::endl;
+            return 1;
+        }
+    }
+    return entry.status;
+}
@@ -0,0 +1,55 @@
+#ifndef CACHE_H
+#define CACHE_H 1
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "options.hpp"
+
+// Pamięć podręczna kompilacji na dysku, adresowana treścią: kluczem jest
+// hasz źródła razem z wersją kompilatora i opcjami, wpis przechowuje kod,
+// log (diagnostyki) i kod wyjścia. Wpis zawiera też pełny klucz, więc
+// kolizja haszy daje chybienie, nigdy cudzy wynik. Wpisy są zapisywane przez
+// rename(), a licznik i usuwanie pod flock(), więc z katalogu może naraz
+// korzystać wiele procesów (np. równoległe shardy CI). Po przekroczeniu
+// limitu znikają najdawniej używane wpisy (czas modyfikacji odświeżany przy
+// trafieniu).
+class CompileCache {
+    public:
+        struct Entry {
+            uint32_t status = 0;
+            bool written = false;
+            std::string code, log;
+        };
+        struct Stats {
+            uint64_t hits = 0, misses = 0, stores = 0, evictions = 0, bytes = 0;
+        };
+
+        // katalog i limit w bajtach
+        CompileCache(const std::string &dir, uint64_t limit);
+        // z KOMPILATOR_CACHE (katalog) i KOMPILATOR_CACHE_LIMIT (MB, domyślnie
+        // 256); false gdy pamięć nie jest włączona
+        static bool configured(std::string &dir, uint64_t &limit);
+
+        bool lookup(const std::string &key, Entry &entry);
+        void store(const std::string &key, const Entry &entry);
+        Stats stats();
+        void print_stats(std::ostream &out);
+
+    private:
+        std::string dir;
+        uint64_t limit;
+
+        std::string path(const std::string &key);
+        // zmiana liczników pod blokadą katalogu, z ewentualnym usuwaniem
+        template<class Update> void update(Update change);
+        void evict(Stats &stats);
+};
+
+// klucz wpisu: wersja kompilatora, opcje i bajty źródła
+std::string cache_key(const std::vector<char> &source, const std::string &options);
+
+// main: kompilacja pliku przez pamięć podręczną, zachowuje się jak compile()
+int compile_cached(CompileCache &cache, const char *input, const char *output, const Options &options);
+#endif
@@ -0,0 +1,93 @@
+// Cienki klient serwera kompilacji (kompilator --serve): wywołuje się go
+// tak samo jak kompilator, z tymi samymi opcjami przed plikami, ale
+// parsowanie i generacja odbywają się w działającym serwerze. Gniazdo
+// z KOMPILATOR_SOCKET, domyślnie /tmp/kompilator.sock.
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "options.hpp"
+#include "protocol.hpp"
+
+static int connect_server(const char *path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    std::strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool write_file(const std::string &path, const std::vector<char> &data) {
+    std::ofstream output(path, std::ios::binary);
+    output.write(data.data(), data.size());
+    output.close();
+    if (!output) {
+        std::cerr << "Cannot write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    // opcje sprawdzane tak jak w kompilatorze, a do serwera idą w postaci
+    // z linii poleceń i tam są czytane jeszcze raz
+    Options options;
+    std::vector<std::string> flags;
+    while (argc > 1 && options.parse(argv[1])) {
+        flags.push_back(argv[1]);
+        argv++;
+        argc--;
+    }
+    if (argc != 3) {
+        std::cout << "Program usage:\n\tkompilator-client [Options] Input_File Output_File"
+            << "\nOptions are the same as the compiler's (-O..., --emit=..., --line-map, -Rpass, ...)" << std::endl;
+        return 0;
+    }
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input) {
+        std::cerr << "No such file: " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<char> source((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    const char *path = std::getenv("KOMPILATOR_SOCKET");
+    if (!path) {
+        path = "/tmp/kompilator.sock";
+    }
+    int fd = connect_server(path);
+    if (fd < 0) {
+        std::cerr << "Cannot connect to server: " << path << std::endl;
+        return 1;
+    }
+    uint32_t status;
+    bool written;
+    std::vector<char> code, map, log;
+    bool answered = protocol::write_request(fd, flags, source)
+        && protocol::read_response(fd, status, written, code, map, log);
+    close(fd);
+    if (!answered) {
+        std::cerr << "Server closed the connection: " << path << std::endl;
+        return 1;
+    }
+    std::cerr.write(log.data(), log.size());
+    if (written) {
+        if (!write_file(argv[2], code) || (options.line_map && !write_file(std::string(argv[2]) + ".map", map))) {
+            return 1;
+        }
+    }
+    return status;
+}
@@ -3,36 +3,142 @@
 #include "ast.hpp"
 #include "asm.hpp"
 #include "symbols.hpp"
+#include "eval.hpp"
+#include "estimate.hpp"
+#include "context.hpp"
 
-extern Symbols symbols;
 
+CodeGen::CodeGen(Context &ctx) : ctx(ctx), remarks(ctx.options) {}
 
-std::vector<Instruction *> CodeGen::generate(ast::Node *root) {
-    return root->gen_ir(&instruction_counter);
+std::vector<Instruction> CodeGen::generate(ast::Node *root) {
+    Emitter out(instruction_counter);
+    root->gen_ir(ctx, out);
+    instruction_counter = out.label;
+    sites.swap(out.sites);
+    return out.code;
 }
-    bool CodeGen::generate_to(std::ostream &stream, ast::Node *root) {
-    auto code = root->gen_ir(&instruction_counter);
+    bool CodeGen::generate_to(AsmWriter &writer, ast::Node *root, AsmWriter *map) {
+    auto code = generate(root);
     if (n_error > 0) {
-        std::cerr << "Compilation" << " failed: " <<   n_error << " errors found." << std::endl;
+        ctx.log << "Compilation" << " failed: " <<   n_error << " errors found." << std::endl;
         return false;
     } else {
-        for(int i = 0; i < code.size(); i++) {
-            
-            stream << *code[i];
+        {
+            PhaseScope phase(ctx.timing, Phase::Optimize);
+            ctx.passes.run(Stage::Code, (ast::Program*)root, &code);
+        }
+        remarks.write(ctx.log);
+        if (ctx.options.cost_report != Report::None) {
+            CostReport(code, sites).write(ctx.log, ctx.options.cost_report);
+        }
+        {
+            PhaseScope phase(ctx.timing, Phase::Output);
+            if (ctx.options.emit == Emit::Binary) {
+                writer.format_object(code, ctx.options.line_map);
+            } else {
+                writer.format(code);
+            }
+            if (map) {
+                map->format_lines(code, sites);
+            }
+        }
+        // licznik tylko do raportu czasów, zwykła kompilacja kończy się samym
+        // "Compilation successful"
+        if (n_eliminated > 0 && ctx.options.time_report != Report::None) {
+            ctx.log << "Dead code elimination: " << n_eliminated << " instructions removed" << std::endl;
         }
         return true;
     }
 }
 
+bool CodeGen::generate_to(std::ostream &stream, ast::Node *root, AsmWriter *map) {
+    AsmWriter writer;
+    bool result = generate_to(writer, root, map);
+    stream.write(writer.data(), writer.size());
+    return result;
+}
+
+// Pełny kod jest już sprawdzony (wszystkie błędy zgłoszone), więc program
+// rezydualny generujemy po cichu od zera, a przy problemie zostaje pełny kod
+// razem ze swoją tablicą symboli. Z -Os także wtedy, gdy rezydualny nie jest
+// krótszy (np. rozwinięta w czasie kompilacji pętla wypisująca stałe).
+bool CodeGen::partial_eval(ast::Program *program, std::vector<Instruction> &code) {
+    if (ctx.errors > 0) {
+        return false;
+    }
+    ast::Program *residual = ast::PartialEval(ctx, program).run();
+    if (!residual) {
+        return false;
+    }
+    Symbols full = std::move(ctx.symbols);
+    ctx.symbols = Symbols();
+    Emitter folded;
+    int64_t eliminated = n_eliminated;
+    n_eliminated = 0;
+    size_t mark = remarks.mark();
+    silent = true;
+    residual->gen_ir(ctx, folded);
+    silent = false;
+    bool larger = ctx.options.level == Level::Os && folded.code.size() >= code.size();
+    if (n_error > 0 || larger) {
+        n_error = 0;
+        n_eliminated = eliminated;
+        ctx.symbols = std::move(full);
+        remarks.rollback(mark);
+        if (larger && remarks.enabled()) {
+            int64_t cost = 0;
+            for (const Instruction &instruction : folded.code) {
+                cost += asm_cost(instruction.command);
+            }
+            remarks.missed("partial-eval", 0, "residual program is not smaller than the full one (-Os)",
+                folded.code.size(), cost);
+        }
+        return false;
+    }
+    remarks.drop_before(mark);
+    if (remarks.enabled()) {
+        int64_t cost = 0;
+        for (const Instruction &instruction : code) {
+            cost += asm_cost(instruction.command);
+        }
+        for (const Instruction &instruction : folded.code) {
+            cost -= asm_cost(instruction.command);
+        }
+        int64_t instructions = (int64_t)code.size() - (int64_t)folded.code.size();
+        if (instructions > 0 || cost > 0) {
+            remarks.passed("partial-eval", 0, "program prefix independent of input executed at compile time",
+                instructions, cost);
+        }
+    }
+    instruction_counter = folded.label;
+    code.swap(folded.code);
+    sites.swap(folded.sites);
+    return true;
+}
+
+void CodeGen::reset() {
+    instruction_counter = 0;
+    n_error = 0;
+    n_eliminated = 0;
+    silent = false;
+    sites.clear();
+    remarks.clear();
+}
+
 void CodeGen::report(std::string error, int64_t line) {
-    std::cerr << "Error in line " << line << ": "
-            << error << std::endl;
     n_error++;
+    if (silent) {
+        return;
+    }
+    ctx.log << "Error in line " << line << ": "
+            << error << std::endl;
+}
+
+void CodeGen::eliminated(int64_t instructions) {
+    n_eliminated += instructions;
 }
 
 void CodeGen::report(std::ostringstream& error, int64_t line) {
-    std::cerr << "Error in line " << line << ": " 
-            << error.str() << std::endl;
-    n_error++;
+    report(error.str(), line);
 }
 
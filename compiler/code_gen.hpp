@@ -5,15 +5,33 @@
 #include <iostream>
 #include "asm.hpp"
 #include "ast.hpp"
+#include "writer.hpp"
+#include "remarks.hpp"
 
+class Context;
 
 class CodeGen {
+    Context &ctx;
     int64_t instruction_counter = 0;
     int64_t n_error = 0;
+    int64_t n_eliminated = 0;
+    bool silent = false;
+    // instrukcje programu z ostatniej generacji, do mapy linii
+    std::vector<Site> sites;
     public:
-        std::vector<Instruction*> generate(ast::Node *root);
-        bool generate_to(std::ostream &stream, ast::Node *root);
+        // uwagi -Rpass z generacji, której kod trafia do wyniku
+        Remarks remarks;
+
+        CodeGen(Context &ctx);
+        void reset();
+        std::vector<Instruction> generate(ast::Node *root);
+        // true gdy kod programu rezydualnego zastąpił pełny
+        bool partial_eval(ast::Program *program, std::vector<Instruction> &code);
+        // map: mapa linii dla wyniku tekstowego (--line-map) albo NULL
+        bool generate_to(AsmWriter &writer, ast::Node *root, AsmWriter *map = NULL);
+        bool generate_to(std::ostream &stream, ast::Node *root, AsmWriter *map = NULL);
         void report(std::string error, int64_t line);
+        void eliminated(int64_t instructions);
         void report(std::ostringstream& error, int64_t line);
 };
 #endif
\ No newline at end of file
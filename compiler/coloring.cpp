@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include "coloring.hpp"
+
+namespace {
+
+    // krawędzie grafu przepływu: argument skoku to adres rozkazu
+    bool jumps(const std::vector<Instruction> &code, int64_t i) {
+        return code[i].is_jump() && code[i].arg >= 0 && code[i].arg < (int64_t)code.size();
+    }
+
+    bool falls_through(const std::vector<Instruction> &code, int64_t i) {
+        return code[i].command != ASM::JUMP && code[i].command != ASM::HALT && i + 1 < (int64_t)code.size();
+    }
+}
+
+// tablice są posortowane w run() i rozłączne
+bool CellColoring::in_array(int64_t cell) {
+    auto next = std::upper_bound(arrays.begin(), arrays.end(),
+        std::make_pair(cell, std::numeric_limits<int64_t>::max()));
+    return next != arrays.begin() && cell < (next - 1)->second;
+}
+
+// Jedno przejście wstecz z jednym zbiorem komórek żywych na wejściu rozkazu.
+// Zbiór na wejściu celu skoku w przód jest trzymany do ostatniego skoku,
+// który do niego prowadzi. Skok wstecz zamyka pętlę [nagłówek, skok]:
+// komórka żywa na wejściu nagłówka jest żywa też w skoku, więc jej przedział
+// sięga do końca pętli, a w środku pętli otoczka jest już pełna. To daje
+// dokładnie te same przedziały co search(), o ile pętle są zagnieżdżonymi
+// przedziałami (co najwyżej 64 poziomy), do których skoku wstecz dochodzi
+// się tylko przez nagłówek (kod strukturalny); inaczej zwraca false.
+bool CellColoring::sweep() {
+    int64_t n = code.size();
+    // ostatni skok wstecz do nagłówka (-1: nie nagłówek), liczba skoków w przód
+    std::vector<int64_t> loop_end(n, -1), incoming(n, 0);
+    for (int64_t i = 0; i < n; i++) {
+        if (!jumps(code, i)) {
+            continue;
+        }
+        if (code[i].arg <= i) {
+            loop_end[code[i].arg] = std::max(loop_end[code[i].arg], i);
+        } else {
+            incoming[code[i].arg]++;
+        }
+    }
+    // pętle jako przedziały: zagnieżdżone albo rozłączne
+    std::vector<int64_t> inner(n, -1), outer(n, -1), depth(n, -1), open;
+    for (int64_t i = 0; i < n; i++) {
+        while (!open.empty() && loop_end[open.back()] < i) {
+            open.pop_back();
+        }
+        if (loop_end[i] >= 0) {
+            if (open.size() == 64 || (!open.empty() && loop_end[i] > loop_end[open.back()])) {
+                return false;
+            }
+            outer[i] = open.empty() ? -1 : open.back();
+            depth[i] = open.size();
+            open.push_back(i);
+        }
+        inner[i] = open.empty() ? -1 : open.back();
+    }
+    // reach[i]: bit k, gdy skoki w przód prowadzą z i do skoku wstecz
+    // zawierającej i pętli głębokości k. Krawędź w przód, która wchodzi do
+    // pętli z pominięciem nagłówka (np. do wyjścia FOR), nie może do niego
+    // prowadzić.
+    std::vector<uint64_t> reach(n, 0);
+    auto edge = [&](int64_t from, int64_t to) {
+        int64_t head = inner[to];
+        for (; head >= 0 && (from < head || from > loop_end[head]); head = outer[head]) {
+            if (head != to && (reach[to] >> depth[head] & 1)) {
+                return false;
+            }
+        }
+        if (head >= 0) {
+            reach[from] |= reach[to] & (~(uint64_t)0 >> (63 - depth[head]));
+        }
+        return true;
+    };
+    for (int64_t i = n - 1; i >= 0; i--) {
+        if (jumps(code, i) && code[i].arg <= i) {
+            reach[i] |= (uint64_t)1 << depth[code[i].arg];
+        } else if (jumps(code, i) && !edge(i, code[i].arg)) {
+            return false;
+        }
+        if (falls_through(code, i) && !edge(i, i + 1)) {
+            return false;
+        }
+    }
+
+    size_t words = (ranges.size() + 63) / 64;
+    std::vector<uint64_t> live(words, 0);
+    std::unordered_map<int64_t, std::vector<uint64_t>> saved;
+    // komórki, którym podniesiono koniec przedziału, i ich liczba przy
+    // wejściu w pętlę od strony skoku wstecz
+    std::vector<int64_t> raised;
+    std::unordered_map<int64_t, size_t> marks;
+    auto raise = [&](int64_t c, int64_t i) {
+        if (ranges[c].second < i) {
+            ranges[c].second = i;
+            raised.push_back(c);
+        }
+    };
+    for (int64_t i = n - 1; i >= 0; i--) {
+        bool jump = jumps(code, i);
+        if (jump && code[i].arg <= i && loop_end[code[i].arg] == i) {
+            marks[code[i].arg] = raised.size();
+        }
+        int64_t c = cell_of[i];
+        if (c >= 0) {
+            uint64_t bit = (uint64_t)1 << (c & 63);
+            if (code[i].command == ASM::STORE) {
+                if (live[c >> 6] & bit) {
+                    live[c >> 6] &= ~bit;
+                    ranges[c].first = i + 1;
+                }
+            } else if (!(live[c >> 6] & bit)) {
+                live[c >> 6] |= bit;
+                raise(c, i);
+            }
+        } else if (!falls_through(code, i) || (jump && code[i].arg > i)) {
+            bool fall = falls_through(code, i);
+            std::vector<uint64_t> *target = NULL;
+            auto found = saved.end();
+            if (jump && code[i].arg > i) {
+                found = saved.find(code[i].arg);
+                target = &found->second;
+            }
+            for (size_t w = 0; w < words; w++) {
+                uint64_t now = (fall ? live[w] : 0) | (target ? (*target)[w] : 0);
+                for (uint64_t left = live[w] & ~now; left; left &= left - 1) {
+                    ranges[w * 64 + __builtin_ctzll(left)].first = i + 1;
+                }
+                for (uint64_t entered = now & ~live[w]; entered; entered &= entered - 1) {
+                    raise(w * 64 + __builtin_ctzll(entered), i);
+                }
+                live[w] = now;
+            }
+            if (target && --incoming[code[i].arg] == 0) {
+                saved.erase(found);
+            }
+        }
+        if (incoming[i] > 0) {
+            saved[i] = live;
+        }
+        if (loop_end[i] >= 0) {
+            for (size_t k = marks[i], end = raised.size(); k < end; k++) {
+                int64_t r = raised[k];
+                if (live[r >> 6] >> (r & 63) & 1) {
+                    raise(r, loop_end[i]);
+                }
+            }
+        }
+    }
+    for (size_t w = 0; w < words; w++) {
+        for (uint64_t left = live[w]; left; left &= left - 1) {
+            ranges[w * 64 + __builtin_ctzll(left)].first = 0;
+        }
+    }
+    return true;
+}
+
+// Przeszukiwanie wstecz od użyć, osobno dla każdej komórki: kosztuje
+// komórki razy rozkazy, więc tylko dla kodu, którego sweep() nie obejmuje.
+void CellColoring::search() {
+    int64_t n = code.size();
+    std::vector<std::vector<int64_t>> preds(n);
+    std::vector<std::vector<int64_t>> uses(ranges.size());
+    for (int64_t i = 0; i < n; i++) {
+        if (jumps(code, i)) {
+            preds[code[i].arg].push_back(i);
+        }
+        if (falls_through(code, i)) {
+            preds[i + 1].push_back(i);
+        }
+        if (cell_of[i] >= 0 && code[i].command != ASM::STORE) {
+            uses[cell_of[i]].push_back(i);
+        }
+    }
+    std::vector<int64_t> visited(n, -1);
+    std::vector<int64_t> stack;
+    for (int64_t c = 0; c < (int64_t)ranges.size(); c++) {
+        for (int64_t u : uses[c]) {
+            if (visited[u] != c) {
+                visited[u] = c;
+                stack.push_back(u);
+            }
+        }
+        while (!stack.empty()) {
+            int64_t i = stack.back();
+            stack.pop_back();
+            ranges[c].first = std::min(ranges[c].first, i);
+            ranges[c].second = std::max(ranges[c].second, i);
+            for (int64_t p : preds[i]) {
+                // zapis zabija komórkę; do otoczki dochodzi w run()
+                if (visited[p] != c && !(cell_of[p] == c && code[p].command == ASM::STORE)) {
+                    visited[p] = c;
+                    stack.push_back(p);
+                }
+            }
+        }
+    }
+}
+
+int64_t CellColoring::run() {
+    int64_t n = code.size();
+    std::sort(arrays.begin(), arrays.end());
+
+    // komórki skalarne
+    std::unordered_map<int64_t, int64_t> index;
+    cell_of.assign(n, -1);
+    for (int64_t i = 0; i < n; i++) {
+        if (!code[i].is_memory() || code[i].arg == 0 || in_array(code[i].arg)) {
+            continue;
+        }
+        cell_of[i] = index.emplace(code[i].arg, index.size()).first->second;
+    }
+    if (index.empty()) {
+        return 0;
+    }
+
+    // przedział żywotności: otoczka punktów, gdzie komórka jest żywa na
+    // wejściu, oraz jej zapisów (martwy zapis też musi dostać własną komórkę)
+    ranges.assign(index.size(), std::make_pair(n, (int64_t)-1));
+    if (!sweep()) {
+        ranges.assign(index.size(), std::make_pair(n, (int64_t)-1));
+        search();
+    }
+    for (int64_t i = 0; i < n; i++) {
+        if (cell_of[i] >= 0 && code[i].command == ASM::STORE) {
+            ranges[cell_of[i]].first = std::min(ranges[cell_of[i]].first, i);
+            ranges[cell_of[i]].second = std::max(ranges[cell_of[i]].second, i);
+        }
+    }
+
+    // kolorowanie grafu przedziałów zachłannie w kolejności początków:
+    // kolor wraca do wolnych, gdy skończy się jego ostatni przedział,
+    // i bierzemy najniższy wolny
+    std::vector<int64_t> order(ranges.size());
+    for (int64_t c = 0; c < (int64_t)ranges.size(); c++) {
+        order[c] = c;
+    }
+    std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+        return ranges[a] < ranges[b];
+    });
+    typedef std::pair<int64_t, int64_t> End;
+    std::priority_queue<End, std::vector<End>, std::greater<End>> busy;
+    std::priority_queue<int64_t, std::vector<int64_t>, std::greater<int64_t>> idle;
+    std::vector<int64_t> color(ranges.size());
+    int64_t colors = 0;
+    for (int64_t c : order) {
+        while (!busy.empty() && busy.top().first < ranges[c].first) {
+            idle.push(busy.top().second);
+            busy.pop();
+        }
+        if (idle.empty()) {
+            color[c] = colors++;
+        } else {
+            color[c] = idle.top();
+            idle.pop();
+        }
+        busy.push(End(ranges[c].second, color[c]));
+    }
+
+    // kolory na najniższe wolne adresy poza tablicami
+    std::vector<int64_t> address(colors);
+    int64_t next = 1;
+    for (int64_t k = 0; k < colors; k++) {
+        while (in_array(next)) {
+            next++;
+        }
+        address[k] = next++;
+    }
+    for (int64_t i = 0; i < n; i++) {
+        if (cell_of[i] >= 0) {
+            code[i].arg = address[color[cell_of[i]]];
+        }
+    }
+    return ranges.size() - colors;
+}
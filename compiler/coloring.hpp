@@ -0,0 +1,29 @@
+#ifndef COLORING_H
+#define COLORING_H 1
+
+#include <vector>
+#include <utility>
+#include "asm.hpp"
+
+// Przydział komórek pamięci po wygenerowaniu kodu. Dla każdej komórki
+// skalarnej (zmienne, iteratory, tymczasowe) liczymy żywotność na grafie
+// przepływu rozkazów, przedziały żywotności które się przecinają interferują,
+// a kolorowanie zachłanne daje nowe adresy. Tablice zostają na miejscu, bo
+// ich nagłówek trzyma adres bazowy jako liczbę.
+class CellColoring {
+    std::vector<Instruction> &code;
+    std::vector<std::pair<int64_t, int64_t>> arrays;
+    // numer komórki skalarnej, do której sięga rozkaz, albo -1
+    std::vector<int64_t> cell_of;
+    // otoczka punktów, gdzie komórka jest żywa na wejściu
+    std::vector<std::pair<int64_t, int64_t>> ranges;
+    bool in_array(int64_t cell);
+    bool sweep();
+    void search();
+    public:
+        CellColoring(std::vector<Instruction> &code, std::vector<std::pair<int64_t, int64_t>> arrays)
+        : code(code), arrays(arrays) {}
+        // zwraca liczbę zaoszczędzonych komórek
+        int64_t run();
+};
+#endif
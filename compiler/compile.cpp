@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "compile.hpp"
+
+extern int yyparse(void *scanner, Context &ctx);
+
+// parsowanie z przygotowanego skanera; -1 gdy trzeba jeszcze wygenerować kod
+static int parse(Context &ctx) {
+    int syntaxInvalid;
+    {
+        PhaseScope phase(ctx.timing, Phase::Parse);
+        syntaxInvalid = yyparse(ctx.scanner, ctx);
+        scan_release(ctx);
+    }
+    if (syntaxInvalid || ctx.errors > 0) {
+        ctx.log << "Error compiling file: " << ctx.errors << " syntax errors found" << std::endl;
+        return 1;
+    }
+    if (ctx.root == NULL) {
+        return 0;
+    }
+    return -1;
+}
+
+template<class Output> static int generate(Context &ctx, Output &output, AsmWriter *map = NULL) {
+    bool result = ctx.generator.generate_to(output, ctx.root, map);
+    if (result) {
+        ctx.log << "Compilation successful" << std::endl;
+    }
+    return !result;
+}
+
+static int compile_file(Context &ctx, const char *input, const char *output) {
+    FILE *file = NULL;
+    int resultfile = -1;
+    try {
+        // zwykły plik skanujemy zmapowany w pamięć, inne wejścia przez FILE*
+        if (!scan_mapped(ctx, input)) {
+            file = fopen(input, "r");
+            if (!file) {
+                ctx.log << "No such file: " << input << std::endl;
+                return 1;
+            }
+            scan_file(ctx, file);
+        }
+        int status = parse(ctx);
+        if (file) {
+            fclose(file);
+            file = NULL;
+        }
+        if (status >= 0) {
+            return status;
+        }
+        // plik powstaje od razu, także gdy generacja zgłosi błędy
+        resultfile = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        // mapa linii z konstrukcjami idzie do pliku obok (wynik.map), także
+        // przy wyniku binarnym, który ma w sobie tylko same linie
+        bool side_map = ctx.options.line_map;
+        AsmWriter writer, map;
+        status = generate(ctx, writer, side_map ? &map : NULL);
+        PhaseScope phase(ctx.timing, Phase::Output);
+        // nieudany albo niepełny zapis (np. ENOSPC) to błąd kompilacji
+        bool saved = resultfile >= 0 && writer.write_to(resultfile);
+        if (resultfile >= 0 && close(resultfile) < 0) {
+            saved = false;
+        }
+        resultfile = -1;
+        if (!saved) {
+            ctx.log << "Cannot write " << output << std::endl;
+            return 1;
+        }
+        if (side_map) {
+            std::string path = std::string(output) + ".map";
+            int mapfile = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+            bool mapped = mapfile >= 0 && map.write_to(mapfile);
+            if (mapfile >= 0 && close(mapfile) < 0) {
+                mapped = false;
+            }
+            if (!mapped) {
+                ctx.log << "Cannot write " << path << std::endl;
+                return 1;
+            }
+        }
+        return status;
+    } catch (std::exception &e) {
+        scan_release(ctx);
+        if (file) {
+            fclose(file);
+        }
+        if (resultfile >= 0) {
+            close(resultfile);
+        }
+        ctx.log << "Internal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+static int compile_source(Context &ctx, std::vector<char> &source, std::ostream &output, bool &written,
+        std::ostream *map) {
+    written = false;
+    try {
+        // flex skanuje bufor w miejscu, potrzebuje dwóch zer na końcu
+        source.push_back('\0');
+        source.push_back('\0');
+        scan_buffer(ctx, source.data(), source.size());
+        int status = parse(ctx);
+        if (status >= 0) {
+            return status;
+        }
+        written = true;
+        if (!map || !ctx.options.line_map) {
+            return generate(ctx, output);
+        }
+        AsmWriter lines;
+        int result = generate(ctx, output, &lines);
+        map->write(lines.data(), lines.size());
+        return result;
+    } catch (std::exception &e) {
+        scan_release(ctx);
+        ctx.log << "Internal error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+int compile(Context &ctx, const char *input, const char *output) {
+    int status = compile_file(ctx, input, output);
+    ctx.timing.report(ctx.log);
+    return status;
+}
+
+int compile(Context &ctx, std::vector<char> &source, std::ostream &output, bool &written, std::ostream *map) {
+    int status = compile_source(ctx, source, output, written, map);
+    ctx.timing.report(ctx.log);
+    return status;
+}
@@ -0,0 +1,16 @@
+#ifndef COMPILE_H
+#define COMPILE_H 1
+
+#include <ostream>
+#include <vector>
+#include "context.hpp"
+
+// Kompilacja jednego pliku w podanym kontekście, od parsowania do zapisu
+// wyniku. Komunikaty trafiają do ctx.log, błąd wewnętrzny (wyjątek) kończy
+// tylko tę kompilację. Zwraca kod wyjścia jak main: 0 sukces, 1 błąd.
+int compile(Context &ctx, const char *input, const char *output);
+// To samo dla źródła w pamięci (serwer). written mówi, czy main otworzyłby
+// plik wynikowy, czyli czy parsowanie się udało; mapa linii (--line-map)
+// trafia do map, gdy jest podane.
+int compile(Context &ctx, std::vector<char> &source, std::ostream &output, bool &written, std::ostream *map = NULL);
+#endif
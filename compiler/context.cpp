@@ -0,0 +1,10 @@
+#include "context.hpp"
+#include "ast.hpp"
+
+void *ast::Node::operator new(size_t size, Context &ctx) {
+    return ctx.nodes.place<ast::Node>(size);
+}
+
+void *ast::ExprTree::operator new(size_t size, Context &ctx) {
+    return ctx.nodes.place<ast::ExprTree>(size);
+}
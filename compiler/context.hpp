@@ -0,0 +1,80 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H 1
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include "arena.hpp"
+#include "options.hpp"
+#include "names.hpp"
+#include "symbols.hpp"
+#include "code_gen.hpp"
+#include "timing.hpp"
+#include "passes.hpp"
+#include "ast.hpp"
+
+// Stan jednej kompilacji, bez żadnych zmiennych globalnych: parser i lexer
+// są reentrant i dostają kontekst jako parametr, generator dostaje go w
+// gen_ir. Różne konteksty można więc kompilować równolegle w jednym procesie.
+// Węzły AST są alokowane w arenie kontekstu (new (ctx) ...) i zwalniane
+// naraz razem z nim. Rozkazy leżą w ciągłym wektorze Emitter, więc nie
+// potrzebują areny.
+class Context {
+    public:
+        // komunikaty kompilacji (błędy, statystyki optymalizacji)
+        std::ostream &log;
+        Options options;
+        Arena nodes;
+        // nazwy z lexera, jedna kopia na różny identyfikator
+        Names names;
+        Symbols symbols;
+        CodeGen generator;
+        Timing timing;
+        PassManager passes;
+
+        // stan parsera
+        ast::Node *root = NULL;
+        ast::Declarations *decls = NULL;
+        // przypisania do zmiennych tymczasowych z ostatniego wyrażenia
+        // złożonego, trafiają do bloku przed samym przypisaniem
+        std::vector<ast::Command*> prelude;
+        int64_t line = 1;
+        int errors = 0;
+
+        // stan lexera (lex.l): skaner flexa i ewentualnie zmapowany plik
+        void *scanner = NULL;
+        char *mapped = NULL;
+        size_t mapped_length = 0;
+
+        Context(std::ostream &log = std::cerr) : log(log), generator(*this), timing(*this), passes(*this) {}
+        Context(const Context&) = delete;
+        Context &operator=(const Context&) = delete;
+
+        // przygotowanie do kolejnej kompilacji; areny zachowują bloki
+        void reset() {
+            nodes.reset();
+            names.reset();
+            symbols = Symbols();
+            generator.reset();
+            timing.reset();
+            passes.reset();
+            root = NULL;
+            decls = NULL;
+            prelude.clear();
+            line = 1;
+            errors = 0;
+        }
+
+        void release() {
+            nodes.release();
+            names.release();
+        }
+};
+
+// lex.l: wejście z pliku zmapowanego w pamięć albo z FILE*, zwolnienie skanera
+bool scan_mapped(Context &ctx, const char *path);
+void scan_file(Context &ctx, FILE *file);
+// bufor w pamięci, ostatnie dwa z size bajtów muszą być zerami
+void scan_buffer(Context &ctx, char *buffer, size_t size);
+void scan_release(Context &ctx);
+#endif
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include "cse.hpp"
+#include "ast.hpp"
+#include "context.hpp"
+
+namespace ast {
+
+    ValueNumbering::ValueNumbering(Context &ctx)
+        : vars(ctx.symbols.size(), 0), versions(ctx.symbols.size(), 0), ctx(ctx) {}
+
+    int64_t ValueNumbering::fresh() {
+        return next++;
+    }
+
+    void ValueNumbering::set(std::vector<int64_t> &table, int64_t id, int64_t value) {
+        undo.push_back({&table, id, table[id]});
+        table[id] = value;
+    }
+
+    void ValueNumbering::restore(size_t mark) {
+        while (undo.size() > mark) {
+            (*undo.back().table)[undo.back().id] = undo.back().value;
+            undo.pop_back();
+        }
+    }
+
+    // odczyt z tablicy zależy od jej wersji i od wartości indeksu
+    int64_t ValueNumbering::number(Identifier *identifier) {
+        if (identifier->type() == 0) {
+            if (!vars[identifier->id]) {
+                set(vars, identifier->id, fresh());
+            }
+            return vars[identifier->id];
+        }
+        auto key = std::make_tuple(identifier->id, versions[identifier->id], index(identifier));
+        auto cell = cells.find(key);
+        if (cell == cells.end()) {
+            return cells[key] = fresh();
+        }
+        return cell->second;
+    }
+
+    int64_t ValueNumbering::index(Identifier *identifier) {
+        if (identifier->type() == 1) {
+            Value idx(((ConstArray*)identifier)->idx, identifier->line);
+            return number(&idx);
+        }
+        return number(((VarArray*)identifier)->index);
+    }
+
+    int64_t ValueNumbering::number(Value *value) {
+        if (!value->is_const()) {
+            return number(value->identifier);
+        }
+        auto num = consts.find(value->value);
+        if (num == consts.end()) {
+            return consts[value->value] = fresh();
+        }
+        return num->second;
+    }
+
+    int64_t ValueNumbering::number(std::string op, int64_t a, int64_t b) {
+        auto key = std::make_tuple(op, a, b);
+        auto expr = exprs.find(key);
+        if (expr == exprs.end()) {
+            return exprs[key] = fresh();
+        }
+        return expr->second;
+    }
+
+    bool ValueNumbering::holder(int64_t value, Identifier *&identifier) {
+        auto h = holders.find(value);
+        if (h == holders.end() || vars[h->second->id] != value) {
+            return false;
+        }
+        identifier = h->second;
+        return true;
+    }
+
+    // odczyt t(i) kosztuje 6 rozkazów, LOAD zmiennej jeden
+    void ValueNumbering::rewrite(Value *value) {
+        if (!value || value->is_const() || value->identifier->type() != 2) {
+            return;
+        }
+        Identifier *held;
+        if (holder(number(value->identifier), held)) {
+            if (ctx.generator.remarks.enabled()) {
+                ctx.generator.remarks.passed("cse", value->line, std::string("array read ") + value->identifier->name + "("
+                    + ((VarArray*)value->identifier)->index->name + ") replaced by variable " + held->name);
+            }
+            value->identifier = new (ctx) Var(held->name, value->line);
+            value->identifier->id = held->id;
+            replaced++;
+        }
+    }
+
+    void ValueNumbering::assign(Identifier *identifier, int64_t value) {
+        if (identifier->type() == 0) {
+            set(vars, identifier->id, value);
+            holders[value] = identifier;
+            return;
+        }
+        int64_t idx = index(identifier);
+        set(versions, identifier->id, fresh());
+        // kolejny odczyt tej samej komórki da zapisaną wartość
+        cells[std::make_tuple(identifier->id, versions[identifier->id], idx)] = value;
+    }
+
+    void ValueNumbering::renumber(Identifier *identifier) {
+        set(vars, identifier->id, fresh());
+    }
+
+    void ValueNumbering::forget(Identifier *identifier) {
+        set(vars, identifier->id, 0);
+    }
+
+    const ValueNumbering::Writes &ValueNumbering::writes(Commands *commands) {
+        auto found = written.find(commands);
+        if (found != written.end()) {
+            return found->second;
+        }
+        Writes w;
+        for (Command *cmd : commands->commands) {
+            Identifier *target = NULL;
+            if (Assign *assign = dynamic_cast<Assign*>(cmd)) {
+                target = assign->identifier;
+            } else if (Read *read = dynamic_cast<Read*>(cmd)) {
+                target = read->identifier;
+            } else if (If *branch = dynamic_cast<If*>(cmd)) {
+                for (Commands *block : {branch->do_then, branch->do_else}) {
+                    if (block) {
+                        const Writes &inner = writes(block);
+                        w.vars.insert(inner.vars.begin(), inner.vars.end());
+                        w.arrays.insert(inner.arrays.begin(), inner.arrays.end());
+                    }
+                }
+            } else if (While *loop = dynamic_cast<While*>(cmd)) {
+                const Writes &inner = writes(loop->body);
+                w.vars.insert(inner.vars.begin(), inner.vars.end());
+                w.arrays.insert(inner.arrays.begin(), inner.arrays.end());
+            } else if (For *loop = dynamic_cast<For*>(cmd)) {
+                w.vars.insert(loop->iterator->id);
+                const Writes &inner = writes(loop->body);
+                w.vars.insert(inner.vars.begin(), inner.vars.end());
+                w.arrays.insert(inner.arrays.begin(), inner.arrays.end());
+            }
+            if (target) {
+                (target->type() == 0 ? w.vars : w.arrays).insert(target->id);
+            }
+        }
+        return written[commands] = w;
+    }
+
+    // wersje tablic też biorą świeże numery: po cofnięciu stanu z przed
+    // gałęzi licznik nie może trafić w wersję widzianą wewnątrz gałęzi
+    void ValueNumbering::kill(Commands *commands) {
+        const Writes &w = writes(commands);
+        for (int64_t id : w.vars) {
+            set(vars, id, fresh());
+        }
+        for (int64_t id : w.arrays) {
+            set(versions, id, fresh());
+        }
+    }
+
+    void Commands::cse(ValueNumbering &vn) {
+        for (Command *cmd : commands) {
+            cmd->cse(vn);
+        }
+    }
+
+    void Assign::cse(ValueNumbering &vn) {
+        vn.rewrite(expression->left);
+        vn.rewrite(expression->right);
+        int64_t value;
+        if (!expression->right) {
+            value = vn.number(expression->left);
+        } else {
+            std::string op;
+            bool commutative = false;
+            if (dynamic_cast<Plus*>(expression)) {
+                op = "PLUS";
+                commutative = true;
+            } else if (dynamic_cast<Minus*>(expression)) {
+                op = "MINUS";
+            } else if (dynamic_cast<Times*>(expression)) {
+                op = "TIMES";
+                commutative = true;
+            } else if (dynamic_cast<Div*>(expression)) {
+                op = "DIV";
+            } else {
+                op = "MOD";
+            }
+            int64_t a = vn.number(expression->left);
+            int64_t b = vn.number(expression->right);
+            if (commutative && a > b) {
+                std::swap(a, b);
+            }
+            value = vn.number(op, a, b);
+            Identifier *held;
+            if (vn.holder(value, held)) {
+                if (vn.ctx.generator.remarks.enabled()) {
+                    vn.ctx.generator.remarks.passed("cse", line, op + " expression assigned to " + identifier->name
+                        + " reuses the value already held by " + held->name);
+                }
+                Var *var = new (vn.ctx) Var(held->name, line);
+                var->id = held->id;
+                expression = new (vn.ctx) Const(new (vn.ctx) Value(var, line), line);
+                vn.replaced++;
+            }
+        }
+        vn.assign(identifier, value);
+    }
+
+    void If::cse(ValueNumbering &vn) {
+        vn.rewrite(condition->left);
+        vn.rewrite(condition->right);
+        size_t mark = vn.mark();
+        do_then->cse(vn);
+        vn.restore(mark);
+        if (do_else) {
+            do_else->cse(vn);
+            vn.restore(mark);
+        }
+        vn.kill(do_then);
+        if (do_else) {
+            vn.kill(do_else);
+        }
+    }
+
+    // ciało pętli widzi tylko wartości, których żadna iteracja nie zmienia
+    void While::cse(ValueNumbering &vn) {
+        vn.kill(body);
+        size_t mark = vn.mark();
+        if (!reversed) {
+            vn.rewrite(condition->left);
+            vn.rewrite(condition->right);
+            body->cse(vn);
+        } else {
+            body->cse(vn);
+            vn.rewrite(condition->left);
+            vn.rewrite(condition->right);
+        }
+        vn.restore(mark);
+    }
+
+    void For::cse(ValueNumbering &vn) {
+        vn.rewrite(from);
+        vn.rewrite(to);
+        vn.kill(body);
+        size_t mark = vn.mark();
+        vn.renumber(iterator);
+        body->cse(vn);
+        vn.restore(mark);
+        vn.forget(iterator);
+    }
+
+    void Read::cse(ValueNumbering &vn) {
+        vn.assign(identifier, vn.fresh());
+    }
+
+    void Write::cse(ValueNumbering &vn) {
+        vn.rewrite(value);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef CSE_H
+#define CSE_H 1
+
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "ast.hpp"
+
+class Context;
+
+namespace ast {
+
+    // Numerowanie wartości: każda obliczona wartość dostaje numer, a zmienna
+    // która go aktualnie trzyma może zastąpić ponowne liczenie wyrażenia.
+    // Stan przechodzi w dół drzewa (dominatory w kodzie strukturalnym),
+    // gałęzie i pętle zabijają wszystko, co w nich jest przypisywane.
+    class ValueNumbering {
+        // 0 to wersja tablicy, do której jeszcze nic nie zapisano
+        int64_t next = 1;
+        std::map<std::tuple<std::string, int64_t, int64_t>, int64_t> exprs;
+        // odczyt t(i): (numer tablicy, wersja, numer indeksu)
+        std::map<std::tuple<int64_t, int64_t, int64_t>, int64_t> cells;
+        std::map<int64_t, int64_t> consts;
+        std::unordered_map<int64_t, Identifier*> holders;
+        // zmienne i tablice przypisywane w bloku razem z zagnieżdżonymi,
+        // liczone raz na blok, żeby zagnieżdżone pętle nie były kwadratowe
+        struct Writes {
+            std::set<int64_t> vars, arrays;
+        };
+        std::unordered_map<Commands*, Writes> written;
+        const Writes &writes(Commands *commands);
+        // numery wartości zmiennych (0: jeszcze bez numeru) i wersje tablic
+        // w bieżącym punkcie, po numerach symboli
+        std::vector<int64_t> vars;
+        std::vector<int64_t> versions;
+        // poprzednie wartości nadpisanych wpisów; blok cofa tylko to, co sam
+        // zapisał, zamiast kopiować cały stan na wejściu
+        struct Undo {
+            std::vector<int64_t> *table;
+            int64_t id, value;
+        };
+        std::vector<Undo> undo;
+        void set(std::vector<int64_t> &table, int64_t id, int64_t value);
+        public:
+            // kontekst, w którego arenie powstają wstawiane węzły
+            Context &ctx;
+            int64_t replaced = 0;
+
+            // identyfikatory muszą być już związane (Program::gen_ir)
+            ValueNumbering(Context &ctx);
+            int64_t fresh();
+            int64_t number(Identifier *identifier);
+            int64_t number(Value *value);
+            int64_t number(std::string op, int64_t a, int64_t b);
+            int64_t index(Identifier *identifier);
+            bool holder(int64_t value, Identifier *&identifier);
+            void rewrite(Value *value);
+            void assign(Identifier *identifier, int64_t value);
+            void kill(Commands *commands);
+            // zmienna dostaje nowy numer albo traci go zupełnie
+            void renumber(Identifier *identifier);
+            void forget(Identifier *identifier);
+            size_t mark() { return undo.size(); }
+            void restore(size_t mark);
+    };
+}
+#endif
@@ -0,0 +1,168 @@
+#include <iomanip>
+#include <limits>
+#include <string>
+#include "estimate.hpp"
+
+static const int64_t infinity = std::numeric_limits<int64_t>::max();
+
+// szacunki mogą przekroczyć zakres przy zagnieżdżonych długich pętlach
+static int64_t add(int64_t a, int64_t b) {
+    return a > infinity - b ? infinity : a + b;
+}
+
+static int64_t multiply(int64_t a, int64_t b) {
+    return a != 0 && b > infinity / a ? infinity : a * b;
+}
+
+static bool is_loop(Construct construct) {
+    return construct == Construct::While || construct == Construct::For;
+}
+
+CostReport::CostReport(const std::vector<Instruction> &code, const std::vector<Site> &sites) {
+    row(0, Construct::None);
+    // ostatnia instrukcja złożona w danej linii, rodzic dla instrukcji z jej ciała
+    std::map<int32_t, size_t> compound;
+    for (const Site &site : sites) {
+        Key key(site.line, site.construct);
+        auto found = index.find(key);
+        size_t current;
+        if (found != index.end()) {
+            current = found->second;
+            if (rows[current].trips != site.trips) {
+                rows[current].trips = -1;
+            }
+        } else {
+            current = rows.size();
+            rows.push_back(Row());
+            rows[current].line = site.line;
+            rows[current].construct = site.construct;
+            rows[current].trips = site.trips;
+            index[key] = current;
+            auto parent = compound.find(site.parent);
+            if (site.parent != 0 && parent != compound.end()) {
+                rows[parent->second].children.push_back(current);
+                rows[current].depth = rows[parent->second].depth + 1;
+            } else {
+                top.push_back(current);
+            }
+        }
+        if (site.construct == Construct::If || is_loop(site.construct)) {
+            compound[site.line] = current;
+        }
+    }
+    for (const Instruction &instruction : code) {
+        Row &owner_row = rows[owner(instruction)];
+        owner_row.instructions++;
+        owner_row.cost += asm_cost(instruction.command);
+    }
+    for (size_t current : top) {
+        estimate(current);
+    }
+}
+
+// wiersz dla pary (linia, rodzaj), nowy trafia na najwyższy poziom
+size_t CostReport::row(int32_t line, Construct construct) {
+    Key key(line, construct);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        return found->second;
+    }
+    rows.push_back(Row());
+    rows.back().line = line;
+    rows.back().construct = construct;
+    index[key] = rows.size() - 1;
+    top.push_back(rows.size() - 1);
+    return rows.size() - 1;
+}
+
+// wyrażenie należy do przypisania, warunek do IF albo WHILE z tej linii
+size_t CostReport::owner(const Instruction &instruction) {
+    if (instruction.line == 0) {
+        return 0;
+    }
+    Construct construct = instruction.construct;
+    if (construct >= Construct::Plus && construct <= Construct::Mod) {
+        construct = Construct::Assign;
+    } else if (construct == Construct::Condition) {
+        construct = index.count(Key(instruction.line, Construct::If)) ? Construct::If : Construct::While;
+    }
+    return row(instruction.line, construct);
+}
+
+void CostReport::estimate(size_t current) {
+    Row &row = rows[current];
+    int64_t body = 0;
+    for (size_t child : row.children) {
+        estimate(child);
+        body = add(body, rows[child].estimated);
+        row.exact = row.exact && rows[child].exact;
+    }
+    if (is_loop(row.construct) && row.trips < 0) {
+        row.exact = false;
+    }
+    row.estimated = add(row.cost, multiply(row.trips >= 0 ? row.trips : 1, body));
+}
+
+void CostReport::write(std::ostream &out, Report format) {
+    if (format == Report::None) {
+        return;
+    }
+    int64_t instructions = 0, cost = 0, estimated = 0;
+    bool exact = true;
+    for (const Row &row : rows) {
+        instructions += row.instructions;
+        cost += row.cost;
+    }
+    for (size_t current : top) {
+        estimated = add(estimated, rows[current].estimated);
+        exact = exact && rows[current].exact;
+    }
+    // kolejność źródła: instrukcja złożona przed swoim ciałem
+    std::vector<size_t> order;
+    std::vector<size_t> pending(top.rbegin(), top.rend());
+    while (!pending.empty()) {
+        size_t current = pending.back();
+        pending.pop_back();
+        order.push_back(current);
+        pending.insert(pending.end(), rows[current].children.rbegin(), rows[current].children.rend());
+    }
+    if (format == Report::Json) {
+        out << "{\"statements\": [";
+        bool first = true;
+        for (size_t current : order) {
+            const Row &row = rows[current];
+            out << (first ? "" : ", ") << "{\"line\": " << row.line << ", \"statement\": \""
+                << (current == 0 ? "init" : construct_name(row.construct)) << "\", \"depth\": " << row.depth
+                << ", \"instructions\": " << row.instructions << ", \"static_cost\": " << row.cost << ", \"trips\": ";
+            if (row.trips >= 0) {
+                out << row.trips;
+            } else {
+                out << "null";
+            }
+            out << ", \"estimated_cost\": " << row.estimated << ", \"exact\": " << (row.exact ? "true" : "false") << "}";
+            first = false;
+        }
+        out << "], \"total\": {\"instructions\": " << instructions << ", \"static_cost\": " << cost
+            << ", \"estimated_cost\": " << estimated << ", \"exact\": " << (exact ? "true" : "false") << "}}" << std::endl;
+        return;
+    }
+    out << "Cost report:\n"
+        << std::setw(8) << "line" << "  " << std::left << std::setw(20) << "statement" << std::right
+        << std::setw(14) << "instructions" << std::setw(14) << "static cost"
+        << std::setw(10) << "trips" << std::setw(18) << "estimated" << "\n";
+    for (size_t current : order) {
+        const Row &row = rows[current];
+        std::string name = current == 0 ? "init" : std::string(2 * row.depth, ' ') + construct_name(row.construct);
+        std::string trips = row.trips >= 0 ? std::to_string(row.trips) : is_loop(row.construct) ? "?" : "";
+        out << std::setw(8) << row.line << "  " << std::left << std::setw(20) << name << std::right
+            << std::setw(14) << row.instructions << std::setw(14) << row.cost
+            << std::setw(10) << trips << std::setw(17) << row.estimated << (row.exact ? "" : "*") << "\n";
+    }
+    out << std::setw(8) << "" << "  " << std::left << std::setw(20) << "total" << std::right
+        << std::setw(14) << instructions << std::setw(14) << cost
+        << std::setw(10) << "" << std::setw(17) << estimated << (exact ? "" : "*") << "\n";
+    if (!exact) {
+        out << "  * with loops of unknown trip count (?) counted as one iteration\n";
+    }
+    out << std::flush;
+}
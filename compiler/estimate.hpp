@@ -0,0 +1,44 @@
+#ifndef ESTIMATE_H
+#define ESTIMATE_H 1
+
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "asm.hpp"
+#include "options.hpp"
+
+// Raport --cost-report: dla każdej instrukcji programu liczba rozkazów
+// i statyczny koszt kodu, który z niej powstał (już po optymalizacjach),
+// oraz szacowany koszt wykonania. Pętla FOR o stałych granicach kosztuje
+// swój kod plus liczba obrotów razy koszt ciała, WHILE i FOR o nieznanych
+// granicach są liczone jako jeden obrót, a IF jako obie gałęzie naraz.
+// Kilka instrukcji tego samego rodzaju w jednej linii (np. przypisania
+// do zmiennych tymczasowych z jednego wyrażenia) to jeden wiersz.
+class CostReport {
+    typedef std::pair<int32_t, Construct> Key;
+    struct Row {
+        int32_t line;
+        Construct construct;
+        int64_t instructions = 0;
+        int64_t cost = 0;
+        int64_t trips = -1;
+        int depth = 0;
+        std::vector<size_t> children;
+        int64_t estimated = 0;
+        // bez pętli o nieznanej liczbie obrotów w środku
+        bool exact = true;
+    };
+    // wiersze w kolejności generacji, wiersz 0 to kod bez linii
+    std::vector<Row> rows;
+    std::map<Key, size_t> index;
+    std::vector<size_t> top;
+
+    size_t row(int32_t line, Construct construct);
+    size_t owner(const Instruction &instruction);
+    void estimate(size_t row);
+    public:
+        CostReport(const std::vector<Instruction> &code, const std::vector<Site> &sites);
+        void write(std::ostream &out, Report format);
+};
+#endif
@@ -0,0 +1,347 @@
+#include <cstdint>
+#include <deque>
+#include "eval.hpp"
+#include "ast.hpp"
+#include "context.hpp"
+
+namespace ast {
+
+    int64_t div_floor(int64_t a, int64_t b) {
+        if (b == 0) {
+            return 0;
+        }
+        int64_t q = a / b;
+        if ((a % b != 0) && ((a < 0) != (b < 0))) {
+            q--;
+        }
+        return q;
+    }
+
+    int64_t mod_floor(int64_t a, int64_t b) {
+        if (b == 0) {
+            return 0;
+        }
+        int64_t r = a % b;
+        if (r != 0 && ((r < 0) != (b < 0))) {
+            r += b;
+        }
+        return r;
+    }
+
+    Env::Env(Declarations *declarations, int64_t budget) : budget(budget) {
+        if (!declarations) {
+            return;
+        }
+        for (Identifier *identifier : declarations->identifiers) {
+            if (identifier->array) {
+                arrays[identifier->name] = (ConstArray*)identifier;
+            }
+        }
+    }
+
+    bool Env::tick() {
+        return ++steps <= budget;
+    }
+
+    bool Env::load(Identifier *identifier, int64_t &result) {
+        int64_t idx;
+        if (identifier->type() == 0) {
+            auto var = vars.find(identifier->name);
+            if (var == vars.end()) {
+                return false;
+            }
+            result = var->second;
+            return true;
+        } else if (identifier->type() == 1) {
+            idx = ((ConstArray*)identifier)->idx;
+        } else {
+            auto index = vars.find(((VarArray*)identifier)->index->name);
+            if (index == vars.end()) {
+                return false;
+            }
+            idx = index->second;
+        }
+        auto array = arrays.find(identifier->name);
+        if (array == arrays.end() || idx < array->second->index_b || idx > array->second->index_e) {
+            return false;
+        }
+        auto cell = cells[identifier->name].find(idx);
+        if (cell == cells[identifier->name].end()) {
+            return false;
+        }
+        result = cell->second;
+        return true;
+    }
+
+    bool Env::store(Identifier *identifier, int64_t value) {
+        int64_t idx;
+        if (identifier->type() == 0) {
+            if (arrays.find(identifier->name) != arrays.end()) {
+                return false;
+            }
+            vars[identifier->name] = value;
+            return true;
+        } else if (identifier->type() == 1) {
+            idx = ((ConstArray*)identifier)->idx;
+        } else {
+            auto index = vars.find(((VarArray*)identifier)->index->name);
+            if (index == vars.end()) {
+                return false;
+            }
+            idx = index->second;
+        }
+        auto array = arrays.find(identifier->name);
+        if (array == arrays.end() || idx < array->second->index_b || idx > array->second->index_e) {
+            return false;
+        }
+        cells[identifier->name][idx] = value;
+        return true;
+    }
+
+    bool Commands::eval(Env &env) {
+        for (Command *cmd : commands) {
+            if (!env.tick() || !cmd->eval(env)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Value::eval(Env &env, int64_t &result) {
+        if (is_const()) {
+            result = value;
+            return true;
+        }
+        return env.load(identifier, result);
+    }
+
+    bool Assign::eval(Env &env) {
+        int64_t value;
+        return expression->eval(env, value) && env.store(identifier, value);
+    }
+
+    bool If::eval(Env &env) {
+        int64_t cond;
+        if (!condition->eval(env, cond)) {
+            return false;
+        }
+        if (cond) {
+            return do_then->eval(env);
+        }
+        return do_else ? do_else->eval(env) : true;
+    }
+
+    bool While::eval(Env &env) {
+        int64_t cond;
+        if (!reversed) {
+            while (true) {
+                if (!condition->eval(env, cond)) {
+                    return false;
+                }
+                if (!cond) {
+                    return true;
+                }
+                if (!body->eval(env)) {
+                    return false;
+                }
+            }
+        }
+        // wersja DO ... ENDDO wraca do ciała dopóki warunek daje 0 (JZERO)
+        do {
+            if (!body->eval(env) || !condition->eval(env, cond)) {
+                return false;
+            }
+        } while (!cond);
+        return true;
+    }
+
+    bool For::eval(Env &env) {
+        int64_t begin, end, count;
+        if (!from->eval(env, begin) || !to->eval(env, end)) {
+            return false;
+        }
+        if (reversed ? __builtin_sub_overflow(begin, end, &count) : __builtin_sub_overflow(end, begin, &count)) {
+            return false;
+        }
+        for (int64_t i = 0; i <= count; i++) {
+            env.vars[iterator->name] = reversed ? begin - i : begin + i;
+            if (!body->eval(env)) {
+                return false;
+            }
+        }
+        env.vars.erase(iterator->name);
+        return true;
+    }
+
+    bool Read::eval(Env &env) {
+        return false;
+    }
+
+    bool Write::eval(Env &env) {
+        int64_t result;
+        if (!value->eval(env, result)) {
+            return false;
+        }
+        env.output.push_back(result);
+        return true;
+    }
+
+    bool Const::eval(Env &env, int64_t &result) {
+        return left->eval(env, result);
+    }
+
+    bool Plus::eval(Env &env, int64_t &result) {
+        int64_t a, b;
+        return left->eval(env, a) && right->eval(env, b) && !__builtin_add_overflow(a, b, &result);
+    }
+
+    bool Minus::eval(Env &env, int64_t &result) {
+        int64_t a, b;
+        return left->eval(env, a) && right->eval(env, b) && !__builtin_sub_overflow(a, b, &result);
+    }
+
+    bool Times::eval(Env &env, int64_t &result) {
+        int64_t a, b;
+        return left->eval(env, a) && right->eval(env, b) && !__builtin_mul_overflow(a, b, &result);
+    }
+
+    bool Div::eval(Env &env, int64_t &result) {
+        int64_t a, b;
+        if (!left->eval(env, a) || !right->eval(env, b) || (a == INT64_MIN && b == -1)) {
+            return false;
+        }
+        result = div_floor(a, b);
+        return true;
+    }
+
+    bool Mod::eval(Env &env, int64_t &result) {
+        int64_t a, b;
+        if (!left->eval(env, a) || !right->eval(env, b) || (a == INT64_MIN && b == -1)) {
+            return false;
+        }
+        result = mod_floor(a, b);
+        return true;
+    }
+
+    // warunki liczą left - right tak jak Minus w gen_ir
+    bool EQ::eval(Env &env, int64_t &result) {
+        int64_t diff;
+        if (!Minus(left, right, line).eval(env, diff)) {
+            return false;
+        }
+        result = diff == 0;
+        return true;
+    }
+
+    bool NEQ::eval(Env &env, int64_t &result) {
+        int64_t diff;
+        if (!Minus(left, right, line).eval(env, diff)) {
+            return false;
+        }
+        result = diff != 0;
+        return true;
+    }
+
+    bool LE::eval(Env &env, int64_t &result) {
+        int64_t diff;
+        if (!Minus(left, right, line).eval(env, diff)) {
+            return false;
+        }
+        result = diff < 0;
+        return true;
+    }
+
+    bool GE::eval(Env &env, int64_t &result) {
+        int64_t diff;
+        if (!Minus(left, right, line).eval(env, diff)) {
+            return false;
+        }
+        result = diff > 0;
+        return true;
+    }
+
+    bool LEQ::eval(Env &env, int64_t &result) {
+        int64_t diff;
+        if (!Minus(left, right, line).eval(env, diff)) {
+            return false;
+        }
+        result = diff <= 0;
+        return true;
+    }
+
+    bool GEQ::eval(Env &env, int64_t &result) {
+        int64_t diff;
+        if (!Minus(left, right, line).eval(env, diff)) {
+            return false;
+        }
+        result = diff >= 0;
+        return true;
+    }
+
+    PartialEval::PartialEval(Context &ctx, Program *program)
+    : ctx(ctx), program(program), env(program->declarations, step_budget) {}
+
+    Program *PartialEval::run() {
+        std::deque<Command*> rest(program->code->commands.begin(), program->code->commands.end());
+        bool folded = false;
+
+        while (!rest.empty()) {
+            Command *cmd = rest.front();
+            int64_t cond;
+            If *branch = dynamic_cast<If*>(cmd);
+            if (branch && branch->condition->eval(env, cond)) {
+                // znany warunek: zostawiamy tylko wybraną gałąź i liczymy dalej
+                rest.pop_front();
+                Commands *taken = cond ? branch->do_then : branch->do_else;
+                if (taken) {
+                    rest.insert(rest.begin(), taken->commands.begin(), taken->commands.end());
+                }
+                folded = true;
+                continue;
+            }
+
+            // pętle mogą przerwać w połowie, więc dla nich trzymamy kopię stanu
+            bool simple = dynamic_cast<Assign*>(cmd) || dynamic_cast<Write*>(cmd) || dynamic_cast<Read*>(cmd);
+            if (simple) {
+                if (!env.tick() || !cmd->eval(env)) {
+                    break;
+                }
+            } else {
+                Env saved = env;
+                if (!env.tick() || !cmd->eval(env)) {
+                    env = saved;
+                    break;
+                }
+            }
+            rest.pop_front();
+            folded = true;
+        }
+
+        if (!folded) {
+            return NULL;
+        }
+
+        int64_t line = rest.empty() ? 0 : rest.front()->line;
+        Commands *residual = new (ctx) Commands();
+        for (int64_t value : env.output) {
+            residual->add_command(new (ctx) Write(new (ctx) Value(value, line), line));
+        }
+        if (!rest.empty()) {
+            // odtworzenie stanu zmiennych potrzebnego reszcie programu
+            for (auto &var : env.vars) {
+                residual->add_command(new (ctx) Assign(new (ctx) Var(var.first, line),
+                    new (ctx) Const(new (ctx) Value(var.second, line), line), line));
+            }
+            for (auto &array : env.cells) {
+                for (auto &cell : array.second) {
+                    residual->add_command(new (ctx) Assign(new (ctx) ConstArray(array.first, cell.first, line),
+                        new (ctx) Const(new (ctx) Value(cell.second, line), line), line));
+                }
+            }
+            for (Command *cmd : rest) {
+                residual->add_command(cmd);
+            }
+        }
+        return new (ctx) Program(program->declarations, residual);
+    }
+}
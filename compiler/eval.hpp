@@ -0,0 +1,51 @@
+#ifndef EVAL_H
+#define EVAL_H 1
+
+#include <unordered_map>
+#include <map>
+#include <string>
+#include <vector>
+#include "ast.hpp"
+#include "names.hpp"
+
+class Context;
+
+namespace ast {
+
+    // Arytmetyka dokładnie taka jak w kodzie generowanym przez Div i Mod:
+    // dzielenie z zaokrągleniem w dół, reszta ze znakiem dzielnika, x/0 = 0
+    int64_t div_floor(int64_t a, int64_t b);
+    int64_t mod_floor(int64_t a, int64_t b);
+
+    // Stan maszyny podczas wykonywania programu w czasie kompilacji
+    class Env {
+        public:
+            int64_t steps = 0;
+            int64_t budget;
+            // nazwy z puli Names; stan idzie do programu rezydualnego
+            // w kolejności alfabetycznej
+            std::unordered_map<const char*, ConstArray*> arrays;
+            std::map<const char*, int64_t, NameLess> vars;
+            std::map<const char*, std::map<int64_t, int64_t>, NameLess> cells;
+            std::vector<int64_t> output;
+
+            Env(Declarations *declarations, int64_t budget);
+            bool tick();
+            bool load(Identifier *identifier, int64_t &result);
+            bool store(Identifier *identifier, int64_t value);
+    };
+
+    // Ewaluacja częściowa: wykonuje prefiks programu niezależny od wejścia
+    // i zwraca program rezydualny (stałe PUT, stan zmiennych, reszta kodu).
+    class PartialEval {
+        Context &ctx;
+        Program *program;
+        Env env;
+        public:
+            static const int64_t step_budget = 1000000;
+
+            PartialEval(Context &ctx, Program *program);
+            Program *run();
+    };
+}
+#endif
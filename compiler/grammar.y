@@ -1,33 +1,47 @@
-%locations
+%define api.pure full
+%parse-param {void *scanner} {Context &ctx}
+%lex-param {void *scanner}
+
+%code requires {
+    #include "ast.hpp"
+    class Context;
+}
+
+%code provides {
+    int yylex(YYSTYPE *lval, void *scanner);
+}
 
 %{
     #include <string>
+    #include <vector>
     #include <iostream> 
     #include "ast.hpp"
+    #include "context.hpp"
 
-    extern ast::Node *root;
-    ast::Declarations *decls = new ast::Declarations();
-    extern int64_t line;
-    int64_t line = 1;
-    extern int yylex();
-
-    int errors = 0;
+    // przypisania pomocnicze wyrażenia złożonego (ctx.prelude) idą przed nim
+    void append(Context &ctx, ast::Commands *commands, ast::Command *command) {
+        for (ast::Command *cmd : ctx.prelude) {
+            commands->add_command(cmd);
+        }
+        ctx.prelude.clear();
+        commands->add_command(command);
+    }
 
-    void yyerror(std::string msg) {
-        errors++;
-        std::cerr << "[" << line-1 << "] " << "ERROR: " << msg << std::endl;
+    void yyerror(void *scanner, Context &ctx, std::string msg) {
+        ctx.errors++;
+        ctx.log << "[" << ctx.line-1 << "] " << "ERROR: " << msg << std::endl;
     }
 %}
 
 %union {
     int token;
-    char* text;
+    const char* text;
     int64_t val;
     ast::Program *program;
     ast::Declarations *declarations;
     ast::Commands *commands;
     ast::Command *command;
-    ast::Expression *expression;
+    ast::ExprTree *tree;
     ast::Condition *condition;
     ast::Value *value;
     ast::Identifier *identifier;
@@ -51,144 +65,152 @@
 %type <declarations> declarations
 %type <commands> commands
 %type <command> command
-%type <expression> expression
+%type <tree> expression
 %type <condition> condition
 %type <value> value
 %type <identifier> identifier
 
 %start program
 
+/* każde parsowanie zaczyna z własną listą deklaracji w arenie kontekstu */
+%initial-action {
+    ctx.decls = new (ctx) ast::Declarations();
+}
+
 %% 
 
 program:
         DECLARE declarations K_BEGIN commands K_END {
-            $$ = new ast::Program(decls, $4);
-            root = $$;
+            $$ = new (ctx) ast::Program(ctx.decls, $4);
+            ctx.root = $$;
         }
     |   K_BEGIN commands K_END {
-            $$ = new ast::Program(decls, $2);
-            root = $$;
+            $$ = new (ctx) ast::Program(ctx.decls, $2);
+            ctx.root = $$;
         }
     ;
 declarations:
         declarations COMMA PIDENTIFIER {
-            decls->declare(new ast::Var($3,line));
+            ctx.decls->declare(new (ctx) ast::Var($3,ctx.line));
         }
     |   declarations COMMA PIDENTIFIER BRACKET_ON NUM COLON NUM BRACKET_OFF {
-            decls->declare(new ast::ConstArray($3,$5,$7,line));
+            ctx.decls->declare(new (ctx) ast::ConstArray($3,$5,$7,ctx.line));
         }
     |   PIDENTIFIER {
-            decls->declare(new ast::Var($1,line));
+            ctx.decls->declare(new (ctx) ast::Var($1,ctx.line));
         }
     |   PIDENTIFIER BRACKET_ON NUM COLON NUM BRACKET_OFF {
-            decls->declare(new ast::ConstArray($1,$3,$5,line));
+            ctx.decls->declare(new (ctx) ast::ConstArray($1,$3,$5,ctx.line));
         }
     ;
 commands:
         commands command {
-            $1->add_command($2);
+            append(ctx, $1, $2);
         }
     |   command {
-        $$ = new ast::Commands();
-        $$->add_command($1);
+        $$ = new (ctx) ast::Commands();
+        append(ctx, $$, $1);
         }
     ;
 command:
         identifier ASSIGN expression SEMICOLON {
-            $$ = new ast::Assign($1, $3, line);
+            $$ = $3->lower(ctx, $1);
         }
     |   IF condition THEN commands ELSE commands ENDIF {
-            $$ = new ast::If($2,$4,$6,line);
+            $$ = new (ctx) ast::If($2,$4,$6,ctx.line);
         }
     |   IF condition THEN commands ENDIF {
-            $$ = new ast::If($2,$4,line);
+            $$ = new (ctx) ast::If($2,$4,ctx.line);
         }
     |   WHILE condition DO commands ENDWHILE {
-            $$ = new ast::While($2,$4,false,line);
+            $$ = new (ctx) ast::While($2,$4,false,ctx.line);
         }
     |   DO commands WHILE condition ENDDO {
-            $$ = new ast::While($4,$2,true,line);
+            $$ = new (ctx) ast::While($4,$2,true,ctx.line);
         }
     |   FOR PIDENTIFIER FROM value TO value DO commands ENDFOR {
-            auto *iterator = new ast::Var($2, ast::Identifier::I, line);
-            decls->declare(iterator);
-            $$ = new ast::For(iterator, $4, $6, $8, false, line, decls->report_for());
+            auto *iterator = new (ctx) ast::Var($2, ast::Identifier::I, ctx.line);
+            ctx.decls->declare(iterator);
+            $$ = new (ctx) ast::For(iterator, $4, $6, $8, false, ctx.line, ctx.decls->report_for());
     }
     |   FOR PIDENTIFIER FROM value DOWNTO value DO commands ENDFOR {
-            auto *iterator = new ast::Var($2, ast::Identifier::I, line);
-            decls->declare(iterator);
-            $$ = new ast::For(iterator, $4, $6, $8, true, line, decls->report_for());
+            auto *iterator = new (ctx) ast::Var($2, ast::Identifier::I, ctx.line);
+            ctx.decls->declare(iterator);
+            $$ = new (ctx) ast::For(iterator, $4, $6, $8, true, ctx.line, ctx.decls->report_for());
     }
     |   READ identifier SEMICOLON {
-            $$ = new ast::Read($2,line);
+            $$ = new (ctx) ast::Read($2,ctx.line);
         }
     |   WRITE value SEMICOLON {
-            $$ = new ast::Write($2,line);
+            $$ = new (ctx) ast::Write($2,ctx.line);
         }
     ;
     expression:
         value { 
-            $$ = new ast::Const($1, line); 
+            $$ = new (ctx) ast::ExprTree($1, ctx.line); 
+        }
+    |   BRACKET_ON expression BRACKET_OFF {
+            $$ = $2;
         }
-    |   value PLUS value { 
-            $$ = new ast::Plus($1, $3, line); 
+    |   expression PLUS expression { 
+            $$ = new (ctx) ast::ExprTree(ast::ExprTree::PLUS, $1, $3, ctx.line); 
         }
-    |   value MINUS value { 
-            $$ = new ast::Minus($1, $3, line); 
+    |   expression MINUS expression { 
+            $$ = new (ctx) ast::ExprTree(ast::ExprTree::MINUS, $1, $3, ctx.line); 
         }
-    |   value TIMES value { 
-            $$ = new ast::Times($1, $3, line); 
+    |   expression TIMES expression { 
+            $$ = new (ctx) ast::ExprTree(ast::ExprTree::TIMES, $1, $3, ctx.line); 
         }
-    |   value DIV value { 
-            $$ = new ast::Div($1, $3, line); 
+    |   expression DIV expression { 
+            $$ = new (ctx) ast::ExprTree(ast::ExprTree::DIV, $1, $3, ctx.line); 
         }
-    |   value MOD value { 
-        $$ = new ast::Mod($1, $3, line); 
+    |   expression MOD expression { 
+            $$ = new (ctx) ast::ExprTree(ast::ExprTree::MOD, $1, $3, ctx.line); 
         }
     ;
 
 condition:
         value EQ value  { 
-            $$ = new ast::EQ($1, $3, line); 
+            $$ = new (ctx) ast::EQ($1, $3, ctx.line); 
         }
     |   value NEQ value { 
-            $$ = new ast::NEQ($1,$3, line); 
+            $$ = new (ctx) ast::NEQ($1,$3, ctx.line); 
         }
     |   value GE value  { 
-            $$ = new ast::GE($1,$3, line); 
+            $$ = new (ctx) ast::GE($1,$3, ctx.line); 
         }
     |   value LE value  { 
-            $$ = new ast::LE($1,$3, line); 
+            $$ = new (ctx) ast::LE($1,$3, ctx.line); 
         }
     |   value LEQ value { 
-            $$ = new ast::LEQ($1,$3, line); 
+            $$ = new (ctx) ast::LEQ($1,$3, ctx.line); 
         }
     |   value GEQ value { 
-            $$ = new ast::GEQ($1,$3, line); 
+            $$ = new (ctx) ast::GEQ($1,$3, ctx.line); 
         }
     ;
 
 value:
         NUM { 
-            $$ = new ast::Value($1, line); 
+            $$ = new (ctx) ast::Value($1, ctx.line); 
         }
     |   identifier {
-            $$ = new ast::Value($1, line);
+            $$ = new (ctx) ast::Value($1, ctx.line);
         }
     ;
 
   identifier:
         PIDENTIFIER {
-            $$ = new ast::Var($1, line);
+            $$ = new (ctx) ast::Var($1, ctx.line);
         }
     |   PIDENTIFIER BRACKET_ON PIDENTIFIER BRACKET_OFF { 
-            $$ = new ast::VarArray($1, new ast::Var($3, line), line); 
+            $$ = new (ctx) ast::VarArray($1, new (ctx) ast::Var($3, ctx.line), ctx.line); 
         }
     |   PIDENTIFIER BRACKET_ON NUM BRACKET_OFF { 
-            $$ = new ast::ConstArray($1, $3, line); 
+            $$ = new (ctx) ast::ConstArray($1, $3, ctx.line); 
         }
     |   PIDENTIFIER BRACKET_ON NEG NUM BRACKET_OFF { 
-            $$ = new ast::ConstArray($1, -$4, line); 
+            $$ = new (ctx) ast::ConstArray($1, -$4, ctx.line); 
         }
     ;
 %%  
\ No newline at end of file
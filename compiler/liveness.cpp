@@ -0,0 +1,137 @@
+#include <utility>
+#include "liveness.hpp"
+#include "ast.hpp"
+
+namespace ast {
+
+    bool SymbolSet::merge(const SymbolSet &other) {
+        bool grown = false;
+        for (size_t i = 0; i < words.size(); i++) {
+            uint64_t merged = words[i] | other.words[i];
+            grown |= merged != words[i];
+            words[i] = merged;
+        }
+        return grown;
+    }
+
+    SymbolSet &Liveness::loop(Command *command) {
+        auto found = loops.find(command);
+        if (found != loops.end()) {
+            return found->second;
+        }
+        return loops.emplace(command, SymbolSet(symbols)).first->second;
+    }
+
+    void Liveness::use(Identifier *identifier) {
+        live.insert(identifier->id);
+        used.insert(identifier->id);
+        if (identifier->type() == 2) {
+            use(((VarArray*)identifier)->index);
+        }
+    }
+
+    void Liveness::use(Value *value) {
+        if (value && !value->is_const()) {
+            use(value->identifier);
+        }
+    }
+
+    void Commands::live(Liveness &lv) {
+        for (auto cmd = commands.rbegin(); cmd != commands.rend(); cmd++) {
+            (*cmd)->live(lv);
+        }
+    }
+
+    void Assign::live(Liveness &lv) {
+        dead = !lv.live.count(identifier->id);
+        if (dead) {
+            return;
+        }
+        lv.used.insert(identifier->id);
+        if (identifier->type() == 0) {
+            lv.live.erase(identifier->id);
+        } else if (identifier->type() == 2) {
+            lv.use(((VarArray*)identifier)->index);
+        }
+        lv.use(expression->left);
+        lv.use(expression->right);
+    }
+
+    // jedna kopia zbioru za instrukcją, gałęzie łączone w miejscu
+    void If::live(Liveness &lv) {
+        SymbolSet out = lv.live;
+        do_then->live(lv);
+        if (do_else) {
+            std::swap(out, lv.live);
+            do_else->live(lv);
+        }
+        lv.live.merge(out);
+        lv.use(condition->left);
+        lv.use(condition->right);
+    }
+
+    // Pętle liczymy do punktu stałego; ostatni przebieg przez ciało odbywa się
+    // już z końcowym zbiorem, więc flagi dead w ciele są poprawne.
+    void While::live(Liveness &lv) {
+        SymbolSet &in = lv.loop(this);
+        if (!reversed) {
+            lv.use(condition->left);
+            lv.use(condition->right);
+            lv.live.merge(in);
+            SymbolSet head = lv.live;
+            while (true) {
+                body->live(lv);
+                lv.live.merge(head);
+                if (lv.live == head) {
+                    break;
+                }
+                head = lv.live;
+            }
+            in = head;
+            return;
+        }
+        SymbolSet out = lv.live;
+        while (true) {
+            lv.use(condition->left);
+            lv.use(condition->right);
+            lv.live.merge(in);
+            body->live(lv);
+            if (lv.live == in) {
+                break;
+            }
+            in = lv.live;
+            lv.live = out;
+        }
+    }
+
+    void For::live(Liveness &lv) {
+        SymbolSet out = lv.live;
+        SymbolSet &in = lv.loop(this);
+        while (true) {
+            lv.live.merge(in);
+            body->live(lv);
+            if (lv.live == in) {
+                break;
+            }
+            in = lv.live;
+            lv.live = out;
+        }
+        lv.live.merge(out);
+        lv.live.erase(iterator->id);
+        lv.use(from);
+        lv.use(to);
+    }
+
+    void Read::live(Liveness &lv) {
+        lv.used.insert(identifier->id);
+        if (identifier->type() == 0) {
+            lv.live.erase(identifier->id);
+        } else if (identifier->type() == 2) {
+            lv.use(((VarArray*)identifier)->index);
+        }
+    }
+
+    void Write::live(Liveness &lv) {
+        lv.use(value);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef LIVENESS_H
+#define LIVENESS_H 1
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ast.hpp"
+
+namespace ast {
+
+    // zbiór symboli po numerach z Symbols::bind, słowo na 64 symbole
+    class SymbolSet {
+        std::vector<uint64_t> words;
+        public:
+            SymbolSet() {}
+            SymbolSet(size_t size) : words((size + 63) / 64, 0) {}
+            bool count(int64_t id) const { return words[id >> 6] >> (id & 63) & 1; }
+            void insert(int64_t id) { words[id >> 6] |= (uint64_t)1 << (id & 63); }
+            void erase(int64_t id) { words[id >> 6] &= ~((uint64_t)1 << (id & 63)); }
+            // suma w miejscu; zwraca true, gdy zbiór urósł
+            bool merge(const SymbolSet &other);
+            bool operator==(const SymbolSet &other) const { return words == other.words; }
+    };
+
+    // Analiza żywotności zmiennych liczona wstecz po AST na zbiorach numerów
+    // symboli, więc identyfikatory muszą być już związane (Program::gen_ir).
+    // Tablica jest traktowana jak jedna zmienna: zapis do komórki jej nie zabija.
+    class Liveness {
+        public:
+            SymbolSet live;
+            // wszystko, do czego odwołuje się kod, który zostanie wygenerowany
+            SymbolSet used;
+            // zbiór na wejściu pętli z jej poprzedniego odwiedzenia. Zbiory
+            // w zewnętrznych pętlach tylko rosną, więc punkt stały pętli
+            // wewnętrznej liczymy od tego miejsca, a nie od zera: ciało jest
+            // przechodzone ponownie tylko gdy zbiór urósł, zamiast
+            // wykładniczo w głębokości zagnieżdżenia
+            std::unordered_map<Command*, SymbolSet> loops;
+
+            Liveness(size_t symbols) : live(symbols), used(symbols), symbols(symbols) {}
+            void use(Identifier *identifier);
+            void use(Value *value);
+            SymbolSet &loop(Command *command);
+        private:
+            size_t symbols;
+    };
+}
+#endif
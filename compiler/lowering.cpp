@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <string>
+#include "ast.hpp"
+#include "context.hpp"
+
+namespace ast {
+
+    // nazwy z cyfrą nie kolidują z identyfikatorami języka ([_a-z]+)
+    Var *Declarations::temporary(Context &ctx, int64_t slot, int64_t line) {
+        while (temporaries <= slot) {
+            declare(new (ctx) Var(ctx.names.intern("_t" + std::to_string(temporaries++)), line));
+        }
+        return new (ctx) Var(ctx.names.intern("_t" + std::to_string(slot)), line);
+    }
+
+    int64_t ExprTree::need() {
+        if (op == LEAF) {
+            return 0;
+        }
+        int64_t l = left->need(), r = right->need();
+        if (l == r) {
+            return l + 1;
+        }
+        return std::max(l, r);
+    }
+
+    Assign *ExprTree::lower(Context &ctx, Identifier *target) {
+        if (op == LEAF) {
+            return new (ctx) Assign(target, new (ctx) Const(value, line), line);
+        }
+        return new (ctx) Assign(target, operation(ctx, 0), line);
+    }
+
+    // Argumenty operatora zajmują komórki slot i slot+1. Cięższe poddrzewo
+    // liczymy pierwsze, a przy remisie prawe, żeby ostatnio zapisana wartość
+    // była lewym argumentem (ładowanym od razu, LOAD po STORE znika w peephole).
+    Expression *ExprTree::operation(Context &ctx, int64_t slot) {
+        bool commutative = op == PLUS || op == TIMES;
+        Value *a, *b;
+        if (left->op == LEAF || right->op == LEAF) {
+            a = left->operand(ctx, slot);
+            b = right->operand(ctx, slot);
+            if (commutative && left->op == LEAF && right->op != LEAF) {
+                std::swap(a, b);
+            }
+        } else if (left->need() > right->need()) {
+            a = left->operand(ctx, slot);
+            b = right->operand(ctx, slot + 1);
+            if (commutative) {
+                std::swap(a, b);
+            }
+        } else {
+            b = right->operand(ctx, slot);
+            a = left->operand(ctx, slot + 1);
+        }
+        switch (op) {
+            case PLUS:
+                return new (ctx) Plus(a, b, line);
+            case MINUS:
+                return new (ctx) Minus(a, b, line);
+            case TIMES:
+                return new (ctx) Times(a, b, line);
+            case DIV:
+                return new (ctx) Div(a, b, line);
+            default:
+                return new (ctx) Mod(a, b, line);
+        }
+    }
+
+    Value *ExprTree::operand(Context &ctx, int64_t slot) {
+        if (op == LEAF) {
+            return value;
+        }
+        Expression *expression = operation(ctx, slot);
+        ctx.prelude.push_back(new (ctx) Assign(ctx.decls->temporary(ctx, slot, line), expression, line));
+        return new (ctx) Value(ctx.decls->temporary(ctx, slot, line), line);
+    }
+}
@@ -1,46 +1,108 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
 #include "ast.hpp"
 #include "asm.hpp"
 #include "code_gen.hpp"
 #include "symbols.hpp"
+#include "context.hpp"
+#include "compile.hpp"
+#include "batch.hpp"
+#include "serve.hpp"
+#include "cache.hpp"
+#include "object.hpp"
+#include "writer.hpp"
 
-extern int yyparse();
-extern int errors;
-extern FILE *yyin;
-
-ast::Node *root;
-Symbols symbols;
-CodeGen generator;
 
+// --disassemble: plik binarny z powrotem na tekst, przez loader z object.hpp
+static int disassemble(const char *input, const char *output) {
+    object::Program program;
+    std::string error;
+    if (!program.open(input, error)) {
+        std::cerr << error << ": " << input << std::endl;
+        return 1;
+    }
+    std::vector<Instruction> code;
+    code.reserve(program.size());
+    for (size_t i = 0; i < program.size(); i++) {
+        code.push_back(Instruction(program.command(i), program.arg(i)));
+    }
+    AsmWriter writer;
+    writer.format(code);
+    // jak w compile(): nieudany albo niepełny zapis to błąd
+    int resultfile = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    bool saved = resultfile >= 0 && writer.write_to(resultfile);
+    if (resultfile >= 0 && close(resultfile) < 0) {
+        saved = false;
+    }
+    if (!saved) {
+        std::cerr << "Cannot write " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
-    if(argc == 3) {
-        yyin = fopen(argv[1], "r");
-        if (!yyin) {
-            std::cerr << "No such file: " << argv[1] << std::endl;
-            return 1;
+    // opcje przed trybem i plikami
+    Options options;
+    while (argc > 1 && options.parse(argv[1])) {
+        argv++;
+        argc--;
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--batch") {
+        // --batch manifest [-j N]
+        int jobs = 0;
+        bool valid = argc == 3 || (argc == 5 && std::string(argv[3]) == "-j");
+        if (argc == 5) {
+            std::istringstream number(argv[4]);
+            valid = valid && (number >> jobs) && number.eof() && jobs > 0;
+        }
+        if (valid) {
+            return run_batch(argv[2], jobs, options);
         }
-        int syntaxInvalid = yyparse();
-        if(syntaxInvalid || errors > 0) {
-            std::cerr << "Error compiling file: " << errors << " syntax errors found" << std::endl;
+    } else if (argc == 3 && std::string(argv[1]) == "--serve") {
+        return run_server(argv[2], options);
+    } else if (argc == 4 && std::string(argv[1]) == "--disassemble") {
+        return disassemble(argv[2], argv[3]);
+    } else if (argc == 2 && std::string(argv[1]) == "--cache-stats") {
+        std::string dir;
+        uint64_t limit;
+        if (!CompileCache::configured(dir, limit)) {
+            std::cerr << "Cache disabled (KOMPILATOR_CACHE not set)" << std::endl;
             return 1;
-        } else {
-            if (root != NULL) {
-                std::ofstream resultfile;
-                resultfile.open(argv[2]);
-
-                bool result = generator.generate_to(resultfile, root);
-                resultfile.close();
-                if (result) {
-                    std::cerr << "Compilation successful" << std::endl;
-                }
-                return !result;
-            }
         }
-    } else {
-        std::cout << "Program usage:\n\tcompiler Input_File Output_File" << std::endl;
+        CompileCache(dir, limit).print_stats(std::cout);
         return 0;
+    } else if(argc == 3) {
+        std::string dir;
+        uint64_t limit;
+        // raport czasów dotyczy tej kompilacji, a pamięć podręczna nie trzyma
+        // osobnego pliku mapy linii, więc wtedy jest pomijana
+        bool cacheable = options.time_report == Report::None && !options.line_map;
+        if (cacheable && CompileCache::configured(dir, limit)) {
+            CompileCache cache(dir, limit);
+            return compile_cached(cache, argv[1], argv[2], options);
+        }
+        Context ctx;
+        ctx.options = options;
+        return compile(ctx, argv[1], argv[2]);
     }
-}
\ No newline at end of file
+    std::cout << "Program usage:\n\tcompiler [Options] Input_File Output_File"
+        << "\n\tcompiler [Options] --batch Manifest_File [-j Threads]"
+        << "\n\tcompiler [Options] --serve Socket_Path"
+        << "\n\tcompiler --cache-stats"
+        << "\n\tcompiler --disassemble Object_File Output_File"
+        << "\nOptions:\n\t-O0|-O1|-O2|-Os\toptimization level (-O2 by default, -Os keeps the smaller program)"
+        << "\n\t--disable-pass=name[,name]\tskip passes: cse, liveness, partial-eval, peephole, coloring"
+        << "\n\t--emit=asm|bin\toutput format (text by default)"
+        << "\n\t--line-map\tinstruction address to source line map (Output_File.map or object line table)"
+        << "\n\t--time-report[=json]\twall time, allocations and peak RSS per phase, time and changes per pass"
+        << "\n\t--cost-report[=json]\tinstructions, static and estimated cost per statement"
+        << "\n\t-Rpass[=regex]\tJSON remark for each applied optimization, only passes matching regex"
+        << "\n\t-Rpass-missed[=regex]\tJSON remark for each missed optimization, only passes matching regex" << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstring>
+#include "names.hpp"
+
+// FNV-1a
+uint64_t Names::hash(const char *text, size_t length) {
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        h ^= (unsigned char)text[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void Names::grow() {
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.resize(old.empty() ? 1024 : old.size() * 2);
+    size_t mask = slots.size() - 1;
+    for (Slot &slot : old) {
+        if (slot.text) {
+            size_t i = slot.hash & mask;
+            while (slots[i].text) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+    }
+}
+
+const char *Names::intern(const char *text, size_t length) {
+    if (2 * (count + 1) > slots.size()) {
+        grow();
+    }
+    uint64_t h = hash(text, length);
+    size_t mask = slots.size() - 1;
+    size_t i = h & mask;
+    while (slots[i].text) {
+        Slot &slot = slots[i];
+        if (slot.hash == h && slot.length == length && std::memcmp(slot.text, text, length) == 0) {
+            return slot.text;
+        }
+        i = (i + 1) & mask;
+    }
+    char *copy = (char*)pool.allocate(length + 1, 1);
+    std::memcpy(copy, text, length);
+    copy[length] = '\0';
+    slots[i].text = copy;
+    slots[i].length = length;
+    slots[i].hash = h;
+    count++;
+    return copy;
+}
+
+// pusta pula, ale z zachowaną pamięcią tablicy i areny
+void Names::reset() {
+    pool.reset();
+    std::fill(slots.begin(), slots.end(), Slot());
+    count = 0;
+}
+
+void Names::release() {
+    pool.release();
+    slots.clear();
+    count = 0;
+}
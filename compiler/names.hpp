@@ -0,0 +1,37 @@
+#ifndef NAMES_H
+#define NAMES_H 1
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "arena.hpp"
+
+// Pula identyfikatorów dla lexera. Każda nazwa jest kopiowana do areny raz,
+// kolejne wystąpienia dostają ten sam wskaźnik (stabilny do release()).
+// Tablica haszująca z adresowaniem otwartym, rośnie przy połowie zajętości.
+class Names {
+    struct Slot {
+        const char *text = NULL;
+        size_t length = 0;
+        uint64_t hash = 0;
+    };
+    Arena pool;
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    static uint64_t hash(const char *text, size_t length);
+    void grow();
+    public:
+        const char *intern(const char *text, size_t length);
+        const char *intern(const std::string &text) { return intern(text.data(), text.size()); }
+        size_t size() { return count; }
+        void reset();
+        void release();
+};
+// porządek alfabetyczny nazw z puli, gdy kolejność jest widoczna w wyniku
+struct NameLess {
+    bool operator()(const char *a, const char *b) const { return std::strcmp(a, b) < 0; }
+};
+#endif
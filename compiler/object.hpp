@@ -0,0 +1,167 @@
+#ifndef OBJECT_H
+#define OBJECT_H 1
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "asm.hpp"
+
+// Binarny format skompilowanego programu (--emit=bin) i loader dla maszyny
+// wirtualnej, bez parsowania tekstu. Plik to nagłówek, pula stałych
+// (int64), strumień rozkazów (uint32) i opcjonalna tablica linii źródła
+// (int64 na rozkaz). Sekcje są wyrównane do 8 bajtów i zapisane w porządku
+// bajtów maszyny, więc po zmapowaniu pliku są gotowymi tablicami.
+//
+// Rozkaz: kod operacji (kolejność jak w enum ASM) w górnym bajcie, argument
+// w dolnych 24 bitach: wartość poniżej 2^23 wprost, 0xFFFFFF brak argumentu,
+// inaczej 2^23 + indeks w puli stałych.
+//
+// Loader jest w całości w tym pliku (potrzebuje tylko asm.hpp), żeby mogła
+// go dołączyć dowolna maszyna wirtualna.
+namespace object {
+
+    const char magic[4] = {'K', 'O', 'B', 'J'};
+    const uint16_t version = 1;
+    const uint32_t byte_order = 0x01020304;
+    // flagi nagłówka
+    const uint16_t has_lines = 1;
+
+    const uint32_t no_arg = 0xFFFFFF;
+    const uint32_t constant = 0x800000;
+
+    struct Header {
+        char magic[4];
+        uint16_t version;
+        uint16_t flags;
+        uint32_t byte_order;
+        uint32_t reserved;
+        uint64_t instructions;
+        uint64_t constants;
+        uint64_t constants_offset;
+        uint64_t code_offset;
+        uint64_t lines_offset;
+        uint64_t size;
+    };
+
+    inline uint64_t align(uint64_t offset) {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+
+    // Program wczytany z pliku (zmapowany) albo z bufora w pamięci.
+    // Poprawność pliku jest sprawdzana raz przy wczytaniu, potem command()
+    // i arg() nie sprawdzają już niczego.
+    class Program {
+        const char *base = NULL;
+        size_t length = 0;
+        bool mapped = false;
+        const Header *header = NULL;
+        const int64_t *constants = NULL;
+        const uint32_t *code = NULL;
+        const int64_t *lines = NULL;
+
+        bool fail(std::string &error, const char *message) {
+            error = message;
+            close();
+            return false;
+        }
+
+        public:
+            Program() {}
+            Program(const Program&) = delete;
+            Program &operator=(const Program&) = delete;
+            ~Program() { close(); }
+
+            // data musi być wyrównane do 8 bajtów i żyć dłużej niż Program
+            bool load(const char *data, size_t size, std::string &error) {
+                close();
+                base = data;
+                length = size;
+                header = (const Header*)data;
+                if (size < sizeof(Header) || std::memcmp(header->magic, magic, sizeof(magic)) != 0) {
+                    return fail(error, "not an object file");
+                }
+                if (header->version != version || header->byte_order != byte_order) {
+                    return fail(error, "unsupported object file version or byte order");
+                }
+                uint64_t n = header->instructions;
+                bool lines_ok = !(header->flags & has_lines)
+                    || (header->lines_offset % 8 == 0 && header->lines_offset <= size && (size - header->lines_offset) / 8 >= n);
+                if (header->size != size || header->constants_offset % 8 != 0 || header->code_offset % 4 != 0
+                        || header->constants_offset > size || (size - header->constants_offset) / 8 < header->constants
+                        || header->code_offset > size || (size - header->code_offset) / 4 < n || !lines_ok) {
+                    return fail(error, "truncated or corrupt object file");
+                }
+                constants = (const int64_t*)(data + header->constants_offset);
+                code = (const uint32_t*)(data + header->code_offset);
+                lines = header->flags & has_lines ? (const int64_t*)(data + header->lines_offset) : NULL;
+                for (uint64_t i = 0; i < n; i++) {
+                    uint32_t word = code[i];
+                    uint32_t arg = word & 0xFFFFFF;
+                    if ((word >> 24) > (uint32_t)ASM::HALT
+                            || (arg != no_arg && arg >= constant && arg - constant >= header->constants)) {
+                        return fail(error, "invalid instruction in object file");
+                    }
+                }
+                return true;
+            }
+
+            bool open(const char *path, std::string &error) {
+                close();
+                int fd = ::open(path, O_RDONLY);
+                if (fd < 0) {
+                    error = "No such file";
+                    return false;
+                }
+                struct stat st;
+                void *data = MAP_FAILED;
+                if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                }
+                ::close(fd);
+                if (data == MAP_FAILED) {
+                    error = "cannot map object file";
+                    return false;
+                }
+                if (!load((const char*)data, st.st_size, error)) {
+                    munmap(data, st.st_size);
+                    return false;
+                }
+                mapped = true;
+                return true;
+            }
+
+            void close() {
+                if (mapped) {
+                    munmap((void*)base, length);
+                }
+                base = NULL;
+                length = 0;
+                mapped = false;
+                header = NULL;
+                constants = NULL;
+                code = NULL;
+                lines = NULL;
+            }
+
+            size_t size() const { return header ? header->instructions : 0; }
+
+            ASM command(size_t i) const { return (ASM)(code[i] >> 24); }
+
+            // Instruction::Undef gdy rozkaz nie ma argumentu
+            int64_t arg(size_t i) const {
+                uint32_t arg = code[i] & 0xFFFFFF;
+                if (arg == no_arg) {
+                    return Instruction::Undef;
+                }
+                return arg < constant ? arg : constants[arg - constant];
+            }
+
+            bool has_line_table() const { return lines != NULL; }
+            int64_t line(size_t i) const { return lines[i]; }
+    };
+}
+#endif
@@ -0,0 +1,108 @@
+#include <regex>
+#include "options.hpp"
+#include "passes.hpp"
+
+// -Rpass i -Rpass-missed bez wzorca obejmują wszystkie przebiegi
+static bool parse_remarks(const std::string &arg, const std::string &flag, std::string &filter) {
+    if (arg == flag) {
+        filter = ".*";
+        return true;
+    }
+    if (arg.compare(0, flag.size() + 1, flag + "=") != 0 || arg.size() == flag.size() + 1) {
+        return false;
+    }
+    try {
+        std::regex check(arg.substr(flag.size() + 1));
+    } catch (std::regex_error &e) {
+        return false;
+    }
+    filter = arg.substr(flag.size() + 1);
+    return true;
+}
+
+// lista nazw po przecinku, każda musi być zarejestrowanym przebiegiem
+static bool parse_passes(const std::string &list, std::set<std::string> &passes) {
+    std::set<std::string> names;
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string name = list.substr(begin, end - begin);
+        if (!PassManager::known(name)) {
+            return false;
+        }
+        names.insert(name);
+        begin = end + 1;
+    }
+    passes.insert(names.begin(), names.end());
+    return true;
+}
+
+bool Options::parse(const std::string &arg) {
+    static const std::string disable = "--disable-pass=";
+    if (arg == "-O0") {
+        level = Level::O0;
+    } else if (arg == "-O1") {
+        level = Level::O1;
+    } else if (arg == "-O2") {
+        level = Level::O2;
+    } else if (arg == "-Os") {
+        level = Level::Os;
+    } else if (arg.compare(0, disable.size(), disable) == 0) {
+        return parse_passes(arg.substr(disable.size()), disabled);
+    } else if (arg == "--emit=asm") {
+        emit = Emit::Text;
+    } else if (arg == "--emit=bin") {
+        emit = Emit::Binary;
+    } else if (arg == "--line-map") {
+        line_map = true;
+    } else if (arg == "--time-report") {
+        time_report = Report::Text;
+    } else if (arg == "--time-report=json") {
+        time_report = Report::Json;
+    } else if (arg == "--cost-report") {
+        cost_report = Report::Text;
+    } else if (arg == "--cost-report=json") {
+        cost_report = Report::Json;
+    } else if (parse_remarks(arg, "-Rpass", remarks_passed) || parse_remarks(arg, "-Rpass-missed", remarks_missed)) {
+        return true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *level_name(Level level) {
+    static const char *const names[] = {"-O0", "-O1", "-O2", "-Os"};
+    return names[(int)level];
+}
+
+bool Options::reports() const {
+    return time_report != Report::None || cost_report != Report::None
+        || !remarks_passed.empty() || !remarks_missed.empty();
+}
+
+std::string Options::key() const {
+    std::string key = emit == Emit::Binary ? "emit=bin" : "emit=asm";
+    key += " ";
+    key += level_name(level);
+    for (const std::string &pass : disabled) {
+        key += " --disable-pass=" + pass;
+    }
+    if (line_map) {
+        key += " line-map";
+    }
+    // raport kosztu jest w logu, który pamięć podręczna przechowuje
+    if (cost_report != Report::None) {
+        key += cost_report == Report::Json ? " cost-report=json" : " cost-report";
+    }
+    if (!remarks_passed.empty()) {
+        key += " -Rpass=" + remarks_passed;
+    }
+    if (!remarks_missed.empty()) {
+        key += " -Rpass-missed=" + remarks_missed;
+    }
+    return key;
+}
@@ -0,0 +1,44 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H 1
+
+#include <set>
+#include <string>
+
+// format pliku wynikowego
+enum class Emit { Text, Binary };
+// raporty --time-report i --cost-report
+enum class Report { None, Text, Json };
+// -O0: bez przebiegów optymalizacji, -O1: tanie, -O2: wszystkie (domyślnie),
+// -Os: jak -O2, ale bez zmian zwiększających kod
+enum class Level { O0, O1, O2, Os };
+
+// Opcje kompilacji z linii poleceń (przed plikami), wspólne dla zwykłej
+// kompilacji i trybu wsadowego. Trzymane w kontekście.
+struct Options {
+    Emit emit = Emit::Text;
+    Level level = Level::O2;
+    // --disable-pass=nazwa[,nazwa...]: przebiegi wyłączone mimo poziomu
+    std::set<std::string> disabled;
+    Report time_report = Report::None;
+    // statyczny koszt instrukcji programu w logu kompilacji
+    Report cost_report = Report::None;
+    // -Rpass[=wzorzec], -Rpass-missed[=wzorzec]: uwagi optymalizatora dla
+    // przebiegów pasujących do wyrażenia regularnego, puste gdy wyłączone
+    std::string remarks_passed;
+    std::string remarks_missed;
+    // mapa adresów rozkazów na linie źródła: plik obok wyniku (tekst) albo
+    // tablica linii w pliku binarnym
+    bool line_map = false;
+
+    // rozpoznaje jedną opcję; false gdy to nie opcja albo wartość jest zła
+    bool parse(const std::string &arg);
+    // opcje zmieniające wynik kompilacji, część klucza pamięci podręcznej
+    std::string key() const;
+    // czy log udanej kompilacji ma coś poza "Compilation successful"
+    // (raporty, uwagi -Rpass); tryb wsadowy pokazuje go wtedy pod plikiem
+    bool reports() const;
+};
+
+// "-O2" itd.
+const char *level_name(Level level);
+#endif
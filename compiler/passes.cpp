@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include "passes.hpp"
+#include "ast.hpp"
+#include "cse.hpp"
+#include "liveness.hpp"
+#include "peephole.hpp"
+#include "coloring.hpp"
+#include "context.hpp"
+
+namespace {
+
+    enum LevelMask : unsigned {
+        O0 = 1 << (int)Level::O0,
+        O1 = 1 << (int)Level::O1,
+        O2 = 1 << (int)Level::O2,
+        Os = 1 << (int)Level::Os
+    };
+
+    struct Pass {
+        const char *name;
+        Stage stage;
+        // poziomy -O, na których przebieg jest włączony
+        unsigned levels;
+        // zwraca liczbę zmian albo -1
+        int64_t (*run)(Context &ctx, ast::Program *program, std::vector<Instruction> *code);
+    };
+
+    // wspólne podwyrażenia
+    int64_t cse(Context &ctx, ast::Program *program, std::vector<Instruction> *code) {
+        ast::ValueNumbering vn(ctx);
+        program->code->cse(vn);
+        return vn.replaced;
+    }
+
+    // martwe przypisania i nieużywane zmienne; bez tego przebiegu wszystkie
+    // deklaracje dostają pamięć (Program::gen_ir)
+    int64_t liveness(Context &ctx, ast::Program *program, std::vector<Instruction> *code) {
+        ast::Liveness lv(ctx.symbols.size());
+        program->code->live(lv);
+        if (program->declarations) {
+            program->declarations->used.clear();
+            for (ast::Identifier *identifier : program->declarations->identifiers) {
+                if (lv.used.count(identifier->id)) {
+                    program->declarations->used.insert(identifier->name);
+                }
+            }
+        }
+        return -1;
+    }
+
+    int64_t partial_eval(Context &ctx, ast::Program *program, std::vector<Instruction> *code) {
+        return ctx.generator.partial_eval(program, *code) ? 1 : 0;
+    }
+
+    int64_t peephole(Context &ctx, ast::Program *program, std::vector<Instruction> *code) {
+        int64_t removed = Peephole(*code, ctx.symbols.array_ranges()).run();
+        ctx.generator.eliminated(removed);
+        return removed;
+    }
+
+    // liczba wspólnych komórek trafia tylko do tabeli przebiegów --time-report
+    int64_t coloring(Context &ctx, ast::Program *program, std::vector<Instruction> *code) {
+        return CellColoring(*code, ctx.symbols.array_ranges()).run();
+    }
+
+    // -O1 to przebiegi, których czas zależy tylko od rozmiaru programu
+    // (przejścia wstecz na zbiorach bitowych, peephole), -O2 dokłada
+    // numerowanie wartości i wykonanie programu w czasie kompilacji
+    const Pass registry[] = {
+        {pass_names[0], Stage::Program, O2 | Os, cse},
+        {pass_names[1], Stage::Program, O1 | O2 | Os, liveness},
+        {pass_names[2], Stage::Code, O2 | Os, partial_eval},
+        {pass_names[3], Stage::Code, O1 | O2 | Os, peephole},
+        {pass_names[4], Stage::Code, O1 | O2 | Os, coloring},
+    };
+    const size_t count = sizeof(registry) / sizeof(registry[0]);
+}
+
+PassManager::PassManager(Context &ctx) : ctx(ctx), stats(count) {}
+
+static_assert(sizeof(registry) / sizeof(registry[0]) == sizeof(pass_names) / sizeof(pass_names[0]),
+    "every pass name needs a registry entry");
+
+bool PassManager::enabled(const std::string &name) const {
+    for (const Pass &pass : registry) {
+        if (name == pass.name) {
+            return (pass.levels & (1 << (int)ctx.options.level)) && !ctx.options.disabled.count(name);
+        }
+    }
+    return false;
+}
+
+void PassManager::run(Stage stage, ast::Program *program, std::vector<Instruction> *code) {
+    bool timed = ctx.options.time_report != Report::None;
+    for (size_t i = 0; i < count; i++) {
+        const Pass &pass = registry[i];
+        if (pass.stage != stage || !enabled(pass.name)) {
+            continue;
+        }
+        double outer_ms = nested_ms;
+        nested_ms = 0;
+        auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        int64_t changes = pass.run(ctx, program, code);
+        double ms = 0;
+        if (timed) {
+            ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        stats[i].ms += ms - nested_ms;
+        nested_ms = outer_ms + ms;
+        stats[i].runs++;
+        if (changes >= 0) {
+            stats[i].changes = std::max<int64_t>(stats[i].changes, 0) + changes;
+        }
+    }
+}
+
+void PassManager::reset() {
+    for (Stats &pass : stats) {
+        pass = Stats();
+    }
+    nested_ms = 0;
+}
+
+// fragment raportu czasów; wyłączone przebiegi mają runs 0
+void PassManager::report(std::ostream &out, Report format) const {
+    if (format == Report::Json) {
+        out << "\"level\": \"" << level_name(ctx.options.level) << "\", \"passes\": [";
+        for (size_t i = 0; i < count; i++) {
+            out << (i ? ", " : "") << "{\"name\": \"" << registry[i].name << "\", \"enabled\": "
+                << (enabled(registry[i].name) ? "true" : "false") << ", \"runs\": " << stats[i].runs
+                << ", \"wall_ms\": " << stats[i].ms << ", \"changes\": ";
+            if (stats[i].changes >= 0) {
+                out << stats[i].changes;
+            } else {
+                out << "null";
+            }
+            out << "}";
+        }
+        out << "]";
+        return;
+    }
+    out << std::left << std::setw(14) << (std::string("  passes ") + level_name(ctx.options.level)) << std::right
+        << std::setw(12) << "wall ms" << std::setw(14) << "runs" << std::setw(14) << "changes" << "\n";
+    for (size_t i = 0; i < count; i++) {
+        out << "  " << std::left << std::setw(12) << registry[i].name << std::right;
+        if (!enabled(registry[i].name)) {
+            out << std::setw(12) << "off" << "\n";
+            continue;
+        }
+        out << std::setw(12) << stats[i].ms << std::setw(14) << stats[i].runs << std::setw(14);
+        if (stats[i].changes >= 0) {
+            out << stats[i].changes << "\n";
+        } else {
+            out << "-" << "\n";
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef PASSES_H
+#define PASSES_H 1
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "asm.hpp"
+#include "options.hpp"
+
+class Context;
+namespace ast {
+    class Program;
+}
+
+// gdzie działa przebieg: na AST programu przed generacją (także programu
+// rezydualnego po ewaluacji częściowej) albo na wygenerowanym kodzie
+enum class Stage { Program, Code };
+
+// nazwy przebiegów w kolejności uruchamiania (rejestr w passes.cpp ma tę samą);
+// tutaj, żeby opcje dało się sprawdzić bez reszty kompilatora (klient serwera)
+const char *const pass_names[] = {"cse", "liveness", "partial-eval", "peephole", "coloring"};
+
+// Przebiegi optymalizacji zarejestrowane w passes.cpp w ustalonej kolejności:
+// cse, liveness (AST), partial-eval, peephole, coloring (kod). Poziom -O
+// wybiera włączone przebiegi, --disable-pass= wyłącza pojedyncze. Czas,
+// liczba uruchomień i zmian każdego przebiegu trafiają do --time-report
+// (czas bez przebiegów zagnieżdżonych).
+// Wiązanie identyfikatorów i zwykła generacja kodu nie są przebiegami
+// i działają zawsze.
+class PassManager {
+    struct Stats {
+        double ms = 0;
+        int64_t runs = 0;
+        // zastąpione wyrażenia, usunięte rozkazy, ... (-1 gdy nieznane)
+        int64_t changes = -1;
+    };
+    Context &ctx;
+    std::vector<Stats> stats;
+    // czas przebiegów uruchomionych wewnątrz bieżącego (cse i liveness na
+    // programie rezydualnym w partial-eval), odejmowany od jego czasu, żeby
+    // każdy przebieg miał tylko własny czas i tabela się sumowała
+    double nested_ms = 0;
+    public:
+        PassManager(Context &ctx);
+        static bool known(const std::string &name) {
+            for (const char *pass : pass_names) {
+                if (name == pass) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        bool enabled(const std::string &name) const;
+        // code == NULL dla Stage::Program
+        void run(Stage stage, ast::Program *program, std::vector<Instruction> *code);
+        void reset();
+        void report(std::ostream &out, Report format) const;
+};
+#endif
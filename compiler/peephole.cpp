@@ -0,0 +1,72 @@
+#include <unordered_map>
+#include "peephole.hpp"
+
+bool Peephole::scalar(int64_t cell) {
+    if (cell == 0) {
+        return false;
+    }
+    for (auto &array : arrays) {
+        if (cell >= array.first && cell < array.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t Peephole::run() {
+    int64_t n = code.size();
+    std::vector<bool> target(n + 1, false), removed(n, false);
+    for (int64_t i = 0; i < n; i++) {
+        if (code[i].is_jump() && code[i].arg >= 0 && code[i].arg <= n) {
+            target[code[i].arg] = true;
+        }
+    }
+
+    // akumulator już trzyma wartość, jeśli nikt nie skacze na LOAD
+    for (int64_t i = 1; i < n; i++) {
+        if (code[i].command == ASM::LOAD && code[i - 1].command == ASM::STORE
+            && code[i].arg == code[i - 1].arg && !target[i]) {
+            removed[i] = true;
+        }
+    }
+
+    // komórki skalarne bez żadnego odczytu
+    std::unordered_map<int64_t, int64_t> reads;
+    for (int64_t i = 0; i < n; i++) {
+        if (!removed[i] && code[i].is_memory() && code[i].command != ASM::STORE) {
+            reads[code[i].arg]++;
+        }
+    }
+    for (int64_t i = 0; i < n; i++) {
+        if (code[i].command == ASM::STORE && scalar(code[i].arg) && !reads.count(code[i].arg)) {
+            removed[i] = true;
+        }
+    }
+
+    // nowe adresy: skok na usunięty rozkaz trafia w następny pozostały
+    std::vector<int64_t> address(n + 1);
+    int64_t next = 0;
+    for (int64_t i = 0; i < n; i++) {
+        address[i] = next;
+        if (!removed[i]) {
+            next++;
+        }
+    }
+    address[n] = next;
+    if (next == n) {
+        return 0;
+    }
+
+    // rozkazy są wartościami, więc zagęszczamy tablicę w miejscu
+    for (int64_t i = 0; i < n; i++) {
+        if (removed[i]) {
+            continue;
+        }
+        if (code[i].is_jump() && code[i].arg >= 0 && code[i].arg <= n) {
+            code[i].arg = address[code[i].arg];
+        }
+        code[address[i]] = code[i];
+    }
+    code.erase(code.begin() + next, code.end());
+    return n - next;
+}
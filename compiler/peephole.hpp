@@ -0,0 +1,21 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H 1
+
+#include <vector>
+#include <utility>
+#include "asm.hpp"
+
+// Wycieki przez pamięć po wyrażeniach złożonych: LOAD t zaraz po STORE t
+// jest zbędny, a zapis do komórki, której nikt nie czyta, też. Po usunięciu
+// rozkazów adresy skoków są przeliczane.
+class Peephole {
+    std::vector<Instruction> &code;
+    std::vector<std::pair<int64_t, int64_t>> arrays;
+    bool scalar(int64_t cell);
+    public:
+        Peephole(std::vector<Instruction> &code, std::vector<std::pair<int64_t, int64_t>> arrays)
+        : code(code), arrays(arrays) {}
+        // zwraca liczbę usuniętych rozkazów
+        int64_t run();
+};
+#endif
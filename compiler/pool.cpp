@@ -0,0 +1,53 @@
+#include <thread>
+#include "pool.hpp"
+
+WorkPool::WorkPool(size_t threads) {
+    for (size_t i = 0; i < (threads ? threads : 1); i++) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+}
+
+bool WorkPool::take(size_t self, std::function<void()> &task) {
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue &other = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(other.lock);
+        if (!other.tasks.empty()) {
+            task = std::move(other.tasks.back());
+            other.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkPool::work(size_t self) {
+    std::function<void()> task;
+    while (take(self, task)) {
+        task();
+    }
+}
+
+void WorkPool::run(std::vector<std::function<void()>> &tasks) {
+    for (size_t i = 0; i < tasks.size(); i++) {
+        queues[i % queues.size()]->tasks.push_back(std::move(tasks[i]));
+    }
+    tasks.clear();
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < queues.size(); i++) {
+        threads.emplace_back(&WorkPool::work, this, i);
+    }
+    // wątek wołający też pracuje
+    work(0);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
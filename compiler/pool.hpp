@@ -0,0 +1,28 @@
+#ifndef POOL_H
+#define POOL_H 1
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Pula wątków z kradzieżą zadań. Każdy wątek ma własną kolejkę i bierze
+// zadania z jej początku; gdy ją opróżni, kradnie z końca cudzych kolejek,
+// więc kilka długich kompilacji nie blokuje reszty przydzielonej z góry.
+// Zadania nie dodają nowych zadań, więc puste kolejki oznaczają koniec.
+class WorkPool {
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    bool take(size_t self, std::function<void()> &task);
+    void work(size_t self);
+    public:
+        WorkPool(size_t threads);
+        // wykonuje wszystkie zadania i wraca, gdy skończy się ostatnie
+        void run(std::vector<std::function<void()>> &tasks);
+};
+#endif
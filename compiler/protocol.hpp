@@ -0,0 +1,111 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H 1
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <unistd.h>
+
+// Protokół serwera kompilacji (gniazdo Unix, jedno połączenie na plik).
+// Zapytanie: blok z opcjami kompilatora (po jednej w linii, tak jak w linii
+// poleceń przed plikami), blok ze źródłem. Odpowiedź: status (uint32), czy
+// powstał plik wynikowy (uint8), blok z kodem, blok z mapą linii (pusty bez
+// --line-map), blok z logiem. Blok to długość (uint64) i bajty. Liczby
+// w porządku bajtów maszyny, bo obie strony są lokalne.
+namespace protocol {
+
+    // maksymalny rozmiar bloku, chroni serwer przed absurdalną długością
+    const uint64_t max_block = 1ULL << 30;
+
+    inline bool read_all(int fd, void *data, size_t size) {
+        char *at = (char*)data;
+        while (size > 0) {
+            ssize_t got = read(fd, at, size);
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                return false;
+            }
+            at += got;
+            size -= got;
+        }
+        return true;
+    }
+
+    inline bool write_all(int fd, const void *data, size_t size) {
+        const char *at = (const char*)data;
+        while (size > 0) {
+            ssize_t put = write(fd, at, size);
+            if (put < 0 && errno == EINTR) {
+                continue;
+            }
+            if (put <= 0) {
+                return false;
+            }
+            at += put;
+            size -= put;
+        }
+        return true;
+    }
+
+    inline bool write_block(int fd, const char *data, uint64_t size) {
+        return write_all(fd, &size, sizeof(size)) && write_all(fd, data, size);
+    }
+
+    inline bool read_block(int fd, std::vector<char> &block) {
+        uint64_t size;
+        if (!read_all(fd, &size, sizeof(size)) || size > max_block) {
+            return false;
+        }
+        block.resize(size);
+        return read_all(fd, block.data(), size);
+    }
+
+    inline bool write_request(int fd, const std::vector<std::string> &options, const std::vector<char> &source) {
+        std::string list;
+        for (const std::string &option : options) {
+            list += option + "\n";
+        }
+        return write_block(fd, list.data(), list.size()) && write_block(fd, source.data(), source.size());
+    }
+
+    inline bool read_request(int fd, std::vector<std::string> &options, std::vector<char> &source) {
+        std::vector<char> list;
+        if (!read_block(fd, list) || !read_block(fd, source)) {
+            return false;
+        }
+        options.clear();
+        std::string option;
+        for (char c : list) {
+            if (c == '\n') {
+                options.push_back(option);
+                option.clear();
+            } else {
+                option += c;
+            }
+        }
+        return true;
+    }
+
+    inline bool write_response(int fd, uint32_t status, bool written, const std::string &code,
+            const std::string &map, const std::string &log) {
+        uint8_t flag = written;
+        return write_all(fd, &status, sizeof(status)) && write_all(fd, &flag, sizeof(flag))
+            && write_block(fd, code.data(), code.size()) && write_block(fd, map.data(), map.size())
+            && write_block(fd, log.data(), log.size());
+    }
+
+    inline bool read_response(int fd, uint32_t &status, bool &written, std::vector<char> &code,
+            std::vector<char> &map, std::vector<char> &log) {
+        uint8_t flag;
+        if (!read_all(fd, &status, sizeof(status)) || !read_all(fd, &flag, sizeof(flag))) {
+            return false;
+        }
+        written = flag;
+        return read_block(fd, code) && read_block(fd, map) && read_block(fd, log);
+    }
+}
+#endif
@@ -0,0 +1,70 @@
+#!/bin/sh
+# Regresja kosztu wygenerowanego kodu: każdy program z regress/programs jest
+# kompilowany, uruchamiany w maszynie z liczeniem kosztu na stałym wejściu
+# (.in) i porównywany z oczekiwanym wyjściem (.out) oraz z kosztem
+# i rozmiarem kodu zapisanym w regress/baseline.txt. Błąd, gdy wynik się
+# różni, którykolwiek program zdrożeje lub urośnie albo nie ma go
+# w baseline (nowy program dopisuje UPDATE=1). Ten sam program
+# jest też sprawdzany w formacie binarnym (--emit=bin).
+# Użycie: regress/run.sh [kompilator] [vm]
+#   UPDATE=1  zapisuje bieżące koszty jako nowy baseline
+
+COMPILER=${1:-./binary/kompilator}
+VM=${2:-./binary/vm}
+DIR=$(dirname "$0")
+BASELINE=$DIR/baseline.txt
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+failed=0
+: > "$WORK/baseline"
+printf "%-10s %12s %12s %8s %8s  %s\n" program cost baseline size baseline status
+for program in "$DIR"/programs/*.imp; do
+    name=$(basename "$program" .imp)
+    input=${program%.imp}.in
+    if ! "$COMPILER" "$program" "$WORK/$name.s" > /dev/null 2> "$WORK/log" \
+            || ! "$COMPILER" --emit=bin "$program" "$WORK/$name.kob" > /dev/null 2>> "$WORK/log"; then
+        echo "$name: compilation failed"
+        cat "$WORK/log"
+        failed=1
+        continue
+    fi
+    "$VM" "$WORK/$name.s" < "$input" > "$WORK/out" 2> "$WORK/cost"
+    "$VM" "$WORK/$name.kob" < "$input" > "$WORK/out.bin" 2> "$WORK/cost.bin"
+    cost=$(sed -n 's/^Cost: \([0-9]*\), instructions: \([0-9]*\).*/\1/p' "$WORK/cost")
+    size=$(sed -n 's/^Cost: \([0-9]*\), instructions: \([0-9]*\).*/\2/p' "$WORK/cost")
+    echo "$name $cost $size" >> "$WORK/baseline"
+    old_cost=$(awk -v name="$name" '$1 == name { print $2 }' "$BASELINE" 2>/dev/null)
+    old_size=$(awk -v name="$name" '$1 == name { print $3 }' "$BASELINE" 2>/dev/null)
+
+    status=ok
+    if [ -z "$cost" ]; then
+        status="VM error: $(cat "$WORK/cost")"
+    elif ! cmp -s "$WORK/out" "${program%.imp}.out"; then
+        status="WRONG OUTPUT"
+    elif ! cmp -s "$WORK/out" "$WORK/out.bin" || ! cmp -s "$WORK/cost" "$WORK/cost.bin"; then
+        status="BINARY DIFFERS"
+    elif [ -z "$old_cost" ]; then
+        status="NO BASELINE"
+    elif [ "$cost" -gt "$old_cost" ] || [ "$size" -gt "$old_size" ]; then
+        status="MORE EXPENSIVE"
+    elif [ "$cost" -lt "$old_cost" ] || [ "$size" -lt "$old_size" ]; then
+        status="improved"
+    fi
+    case $status in
+        ok|improved) ;;
+        "NO BASELINE") [ -n "$UPDATE" ] || failed=1 ;;
+        *) failed=1 ;;
+    esac
+    printf "%-10s %12s %12s %8s %8s  %s\n" "$name" "$cost" "${old_cost:--}" "$size" "${old_size:--}" "$status"
+done
+
+if [ -n "$UPDATE" ]; then
+    if [ $failed -ne 0 ]; then
+        echo "Baseline not updated: some programs failed"
+        exit 1
+    fi
+    { echo "# program cost instructions"; cat "$WORK/baseline"; } > "$BASELINE"
+    echo "Baseline updated: $BASELINE"
+fi
+exit $failed
@@ -0,0 +1,391 @@
+// Maszyna wirtualna z liczeniem kosztu (ceny rozkazów jak w maszynie z
+// zadania), do testów regresji kosztu wygenerowanego kodu. Czyta program
+// tekstowy albo binarny (--emit=bin, przez object.hpp), wejście ze stdin,
+// wypisuje "> wartość" dla każdego PUT, a na stderr podsumowanie:
+// Cost: koszt, instructions: rozmiar kodu, executed: wykonane rozkazy.
+// Z --profile=plik liczy wykonania i koszt każdego adresu i sumuje je po
+// liniach źródła i rodzajach konstrukcji według mapy linii kompilatora
+// (--line-map, plik program.map albo --map=plik), a z --folded=plik zapisuje
+// stosy zagnieżdżonych instrukcji z kosztem w formacie flamegraph.pl.
+// Użycie: vm [--profile=plik] [--folded=plik] [--map=plik] program < wejście
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "asm.hpp"
+#include "object.hpp"
+
+static const int64_t memory_limit = 1 << 24;
+// najdłuższy program z regress/programs wykonuje ~6 mln rozkazów; pętla bez
+// końca kończy się błędem po około sekundzie
+static const int64_t step_limit = 100000000LL;
+
+static bool load_text(const char *path, std::vector<Instruction> &code) {
+    std::ifstream file(path);
+    std::string line;
+    for (int number = 1; std::getline(file, line); number++) {
+        std::istringstream fields(line);
+        std::string name;
+        if (!(fields >> name)) {
+            continue;
+        }
+        int command = 0;
+        while (command <= (int)ASM::HALT && name != asm_name((ASM)command)) {
+            command++;
+        }
+        if (command > (int)ASM::HALT) {
+            std::cerr << "Unknown instruction in line " << number << ": " << name << std::endl;
+            return false;
+        }
+        Instruction instruction((ASM)command);
+        fields >> instruction.arg;
+        code.push_back(instruction);
+    }
+    return true;
+}
+
+static bool load(const char *path, std::vector<Instruction> &code) {
+    char magic[sizeof(object::magic)] = {0};
+    std::ifstream(path, std::ios::binary).read(magic, sizeof(magic));
+    if (std::memcmp(magic, object::magic, sizeof(magic)) != 0) {
+        return load_text(path, code);
+    }
+    object::Program program;
+    std::string error;
+    if (!program.open(path, error)) {
+        std::cerr << error << ": " << path << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < program.size(); i++) {
+        code.push_back(Instruction(program.command(i), program.arg(i),
+            program.has_line_table() ? program.line(i) : 0, Construct::None));
+    }
+    return true;
+}
+
+// Mapa linii (--line-map): "adres linia konstrukcja" od adresu do następnej
+// pary, potem "site linia konstrukcja rodzic" dla instrukcji programu.
+// Przy kilku instrukcjach w jednej linii liczy się pierwsza.
+static bool load_map(const char *path, std::vector<Instruction> &code, std::multimap<int32_t, Site> &sites) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    size_t from = 0;
+    Site last = {0, Construct::None, 0, -1};
+    auto fill = [&](size_t to) {
+        for (; from < std::min(to, code.size()); from++) {
+            code[from].line = last.line;
+            code[from].construct = last.construct;
+        }
+    };
+    auto parse_construct = [](const std::string &name) {
+        int construct = 0;
+        while (construct <= (int)Construct::Condition && name != construct_name((Construct)construct)) {
+            construct++;
+        }
+        return construct <= (int)Construct::Condition ? (Construct)construct : Construct::None;
+    };
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string first, name;
+        if (!(fields >> first)) {
+            continue;
+        }
+        if (first == "site") {
+            Site site = {0, Construct::None, 0, -1};
+            fields >> site.line >> name >> site.parent;
+            site.construct = parse_construct(name);
+            sites.insert(std::make_pair(site.line, site));
+            continue;
+        }
+        fill(std::stoull(first));
+        fields >> last.line >> name;
+        last.construct = parse_construct(name);
+    }
+    fill(code.size());
+    return true;
+}
+
+// ramka stosu: instrukcja programu z linią, 0 to kod bez linii
+static std::string frame(Construct construct, int32_t line) {
+    if (line == 0) {
+        return "init";
+    }
+    if (construct == Construct::None) {
+        return "line:" + std::to_string(line);
+    }
+    return std::string(construct_name(construct)) + ":" + std::to_string(line);
+}
+
+static bool compound(Construct construct) {
+    return construct == Construct::If || construct == Construct::While || construct == Construct::For;
+}
+
+// Instrukcja programu w linii, do której należy rozkaz danej konstrukcji:
+// wyrażenie należy do przypisania, warunek do IF albo WHILE, a rodzic
+// (construct == None) to dowolna instrukcja złożona. NULL gdy jej nie ma.
+static const Site *find_site(const std::multimap<int32_t, Site> &sites, int32_t line, Construct construct) {
+    auto range = sites.equal_range(line);
+    for (auto site = range.first; site != range.second; ++site) {
+        Construct own = site->second.construct;
+        bool match = construct == Construct::None ? compound(own)
+            : construct == Construct::Condition ? own == Construct::If || own == Construct::While
+            : construct >= Construct::Plus ? own == Construct::Assign
+            : own == construct;
+        if (match) {
+            return &site->second;
+        }
+    }
+    return NULL;
+}
+
+// Stos dla rozkazu: od najbardziej zewnętrznej instrukcji złożonej do
+// instrukcji z jego linii, a wyrażenie lub warunek w niej jako osobny liść.
+static std::string stack(const char *root, const Instruction &instruction, const std::multimap<int32_t, Site> &sites) {
+    std::vector<std::string> frames;
+    const Site *site = find_site(sites, instruction.line, instruction.construct);
+    Construct own = site ? site->construct : instruction.construct;
+    if (instruction.line != 0 && instruction.construct != own) {
+        frames.push_back(construct_name(instruction.construct));
+    }
+    frames.push_back(frame(own, instruction.line));
+    // ograniczenie głębokości chroni przed cyklem w uszkodzonej mapie
+    for (size_t depth = 0; site && site->parent != 0 && depth < sites.size(); depth++) {
+        const Site *parent = find_site(sites, site->parent, Construct::None);
+        if (parent == site) {
+            break;
+        }
+        site = parent;
+        if (site) {
+            frames.push_back(frame(site->construct, site->line));
+        }
+    }
+    std::string result = root;
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+        result += ";" + *frame;
+    }
+    return result;
+}
+
+struct Counter {
+    int64_t executed = 0;
+    int64_t cost = 0;
+};
+
+template<class Key> static std::vector<std::pair<Key, Counter>> by_cost(const std::map<Key, Counter> &counters) {
+    std::vector<std::pair<Key, Counter>> sorted(counters.begin(), counters.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const std::pair<Key, Counter> &a, const std::pair<Key, Counter> &b) {
+        return a.second.cost > b.second.cost;
+    });
+    return sorted;
+}
+
+static double percent(int64_t part, int64_t total) {
+    return total > 0 ? 100.0 * part / total : 0;
+}
+
+// tabele: linie, konstrukcje i najdroższe adresy, każda malejąco po koszcie
+static void write_profile(std::ostream &out, const std::vector<Instruction> &code, const std::vector<int64_t> &counts,
+        const std::multimap<int32_t, Site> &sites, int64_t total) {
+    std::map<int32_t, Counter> lines;
+    std::map<std::string, Counter> constructs;
+    std::map<size_t, Counter> addresses;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        Counter counter;
+        counter.executed = counts[i];
+        counter.cost = counts[i] * asm_cost(code[i].command);
+        for (Counter *sum : {&lines[code[i].line], &constructs[code[i].line ? construct_name(code[i].construct) : "init"], &addresses[i]}) {
+            sum->executed += counter.executed;
+            sum->cost += counter.cost;
+        }
+    }
+    char row[128];
+    out << "line      statement              executed            cost       %\n";
+    for (auto &line : by_cost(lines)) {
+        // różne rodzaje instrukcji z tej linii, np. For/Read
+        std::string statement;
+        auto range = sites.equal_range(line.first);
+        for (auto site = range.first; site != range.second; ++site) {
+            std::string name = construct_name(site->second.construct);
+            if (("/" + statement + "/").find("/" + name + "/") == std::string::npos) {
+                statement += (statement.empty() ? "" : "/") + name;
+            }
+        }
+        if (line.first == 0) {
+            statement = "init";
+        } else if (statement.empty()) {
+            statement = "-";
+        }
+        std::snprintf(row, sizeof(row), "%-9d %-18s %12lld %15lld %7.2f\n", line.first, statement.c_str(),
+            (long long)line.second.executed, (long long)line.second.cost, percent(line.second.cost, total));
+        out << row;
+    }
+    out << "\nconstruct           executed            cost       %\n";
+    for (auto &construct : by_cost(constructs)) {
+        std::snprintf(row, sizeof(row), "%-14s %13lld %15lld %7.2f\n", construct.first.c_str(),
+            (long long)construct.second.executed, (long long)construct.second.cost, percent(construct.second.cost, total));
+        out << row;
+    }
+    out << "\naddress   instruction         line      executed            cost       %\n";
+    auto sorted = by_cost(addresses);
+    for (size_t i = 0; i < sorted.size() && i < 20; i++) {
+        const Instruction &instruction = code[sorted[i].first];
+        std::string text = asm_name(instruction.command);
+        if (instruction.arg != Instruction::Undef) {
+            text += " " + std::to_string(instruction.arg);
+        }
+        std::snprintf(row, sizeof(row), "%-9zu %-18s %6d %13lld %15lld %7.2f\n", sorted[i].first, text.c_str(), instruction.line,
+            (long long)sorted[i].second.executed, (long long)sorted[i].second.cost, percent(sorted[i].second.cost, total));
+        out << row;
+    }
+}
+
+// "stos koszt" na linię, rozkazy o zerowym koszcie pomijane
+static void write_folded(std::ostream &out, const char *root, const std::vector<Instruction> &code,
+        const std::vector<int64_t> &counts, const std::multimap<int32_t, Site> &sites) {
+    std::map<std::string, int64_t> stacks;
+    for (size_t i = 0; i < code.size(); i++) {
+        int64_t weight = counts[i] * asm_cost(code[i].command);
+        if (weight > 0) {
+            stacks[stack(root, code[i], sites)] += weight;
+        }
+    }
+    for (auto &entry : stacks) {
+        out << entry.first << " " << entry.second << "\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string profile, folded, map;
+    int first = 1;
+    for (; first < argc && std::strncmp(argv[first], "--", 2) == 0; first++) {
+        std::string option = argv[first];
+        if (option.compare(0, 10, "--profile=") == 0) {
+            profile = option.substr(10);
+        } else if (option.compare(0, 9, "--folded=") == 0) {
+            folded = option.substr(9);
+        } else if (option.compare(0, 6, "--map=") == 0) {
+            map = option.substr(6);
+        } else {
+            first = argc;
+        }
+    }
+    if (argc - first != 1) {
+        std::cerr << "usage: " << argv[0] << " [--profile=file] [--folded=file] [--map=file] program < input" << std::endl;
+        return 1;
+    }
+    const char *path = argv[first];
+    std::vector<Instruction> code;
+    if (!std::ifstream(path)) {
+        std::cerr << "No such file: " << path << std::endl;
+        return 1;
+    }
+    if (!load(path, code)) {
+        return 1;
+    }
+    bool profiling = !profile.empty() || !folded.empty();
+    std::multimap<int32_t, Site> sites;
+    if (profiling) {
+        if (map.empty()) {
+            map = std::string(path) + ".map";
+        }
+        if (!load_map(map.c_str(), code, sites)) {
+            std::cerr << "No line map " << map << ", compile with --line-map" << std::endl;
+        }
+    }
+    std::vector<int64_t> counts(code.size());
+
+    // deque: dopisanie komórek nie unieważnia referencji, a w cell(0) = cell(arg)
+    // lewa strona może być policzona przed rozszerzeniem pamięci przez prawą
+    std::deque<int64_t> memory(1024);
+    auto cell = [&memory](int64_t address) -> int64_t& {
+        if (address < 0 || address >= memory_limit) {
+            throw std::out_of_range("memory address " + std::to_string(address));
+        }
+        if (address >= (int64_t)memory.size()) {
+            memory.resize(std::max<int64_t>(address + 1, memory.size() * 2));
+        }
+        return memory[address];
+    };
+
+    int64_t total = 0, steps = 0;
+    size_t at = 0;
+    try {
+        while (at < code.size() && code[at].command != ASM::HALT) {
+            if (++steps > step_limit) {
+                throw std::runtime_error("step limit exceeded");
+            }
+            const Instruction &instruction = code[at];
+            int64_t arg = instruction.arg;
+            counts[at]++;
+            total += asm_cost(instruction.command);
+            size_t next = at + 1;
+            switch (instruction.command) {
+                case ASM::GET:
+                    if (std::scanf("%lld", (long long*)&cell(0)) != 1) {
+                        throw std::runtime_error("missing input");
+                    }
+                    break;
+                case ASM::PUT:
+                    std::printf("> %lld\n", (long long)cell(0));
+                    break;
+                case ASM::LOAD: cell(0) = cell(arg); break;
+                case ASM::STORE: cell(arg) = cell(0); break;
+                case ASM::LOADI: cell(0) = cell(cell(arg)); break;
+                case ASM::STOREI: cell(cell(arg)) = cell(0); break;
+                case ASM::ADD: cell(0) += cell(arg); break;
+                case ASM::SUB: cell(0) -= cell(arg); break;
+                case ASM::SHIFT: {
+                    // przesunięcie w prawo zaokrągla w dół, także dla ujemnych
+                    int64_t shift = cell(arg);
+                    if (shift >= 64 || shift <= -64) {
+                        cell(0) = shift > 0 || cell(0) >= 0 ? 0 : -1;
+                    } else if (shift >= 0) {
+                        cell(0) = (int64_t)((uint64_t)cell(0) << shift);
+                    } else {
+                        cell(0) >>= -shift;
+                    }
+                    break;
+                }
+                case ASM::INC: cell(0)++; break;
+                case ASM::DEC: cell(0)--; break;
+                case ASM::JUMP: next = arg; break;
+                case ASM::JPOS: if (cell(0) > 0) next = arg; break;
+                case ASM::JZERO: if (cell(0) == 0) next = arg; break;
+                case ASM::JNEG: if (cell(0) < 0) next = arg; break;
+                case ASM::HALT: break;
+            }
+            at = next;
+        }
+    } catch (std::exception &e) {
+        std::fflush(stdout);
+        std::cerr << "Error at instruction " << at << ": " << e.what() << std::endl;
+        return 2;
+    }
+    std::fflush(stdout);
+    std::cerr << "Cost: " << total << ", instructions: " << code.size() << ", executed: " << steps << std::endl;
+    if (!profile.empty()) {
+        std::ofstream out(profile);
+        write_profile(out, code, counts, sites, total);
+    }
+    if (!folded.empty()) {
+        // korzeń stosu to nazwa programu bez katalogu
+        const char *root = std::strrchr(path, '/') ? std::strrchr(path, '/') + 1 : path;
+        std::ofstream out(folded);
+        write_folded(out, root, code, counts, sites);
+    }
+    return 0;
+}
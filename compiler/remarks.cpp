@@ -0,0 +1,50 @@
+#include <regex>
+#include "remarks.hpp"
+
+void Remarks::passed(const char *pass, int64_t line, const std::string &message, int64_t instructions, int64_t cost) {
+    if (muted == 0 && !options.remarks_passed.empty()) {
+        remarks.push_back(Remark{true, pass, line, message, instructions, cost});
+    }
+}
+
+void Remarks::missed(const char *pass, int64_t line, const std::string &reason, int64_t instructions, int64_t cost) {
+    if (muted == 0 && !options.remarks_missed.empty()) {
+        remarks.push_back(Remark{false, pass, line, reason, instructions, cost});
+    }
+}
+
+static void write_string(std::ostream &out, const std::string &text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+void Remarks::write(std::ostream &out) const {
+    if (remarks.empty()) {
+        return;
+    }
+    // wzorce są sprawdzone w Options::parse
+    std::regex passed_filter(options.remarks_passed.empty() ? "$^" : options.remarks_passed);
+    std::regex missed_filter(options.remarks_missed.empty() ? "$^" : options.remarks_missed);
+    for (const Remark &remark : remarks) {
+        if (!std::regex_search(remark.pass, remark.passed ? passed_filter : missed_filter)) {
+            continue;
+        }
+        out << "{\"kind\": \"" << (remark.passed ? "passed" : "missed") << "\", \"pass\": \"" << remark.pass
+            << "\", \"line\": " << remark.line << (remark.passed ? ", \"message\": " : ", \"reason\": ");
+        write_string(out, remark.message);
+        if (remark.instructions != unknown) {
+            out << (remark.passed ? ", \"instructions_saved\": " : ", \"instructions\": ") << remark.instructions;
+        }
+        if (remark.cost != unknown) {
+            out << (remark.passed ? ", \"cost_saved\": " : ", \"cost\": ") << remark.cost;
+        }
+        out << "}\n";
+    }
+    out << std::flush;
+}
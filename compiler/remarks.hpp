@@ -0,0 +1,61 @@
+#ifndef REMARKS_H
+#define REMARKS_H 1
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "options.hpp"
+
+// Uwagi optymalizatora w stylu -Rpass: zastosowana optymalizacja (passed,
+// z liczbą rozkazów i kosztem, których nie ma w kodzie, gdy dają się
+// policzyć) albo powód, dla którego jej nie było (missed, z rozmiarem
+// i kosztem kodu, który powstał zamiast niej). Zbierane przy generacji
+// i wypisywane po udanej kompilacji jako linie JSON, przefiltrowane
+// wyrażeniami regularnymi z -Rpass=... i -Rpass-missed=... po nazwie przebiegu.
+class Remarks {
+    struct Remark {
+        bool passed;
+        const char *pass;
+        int64_t line;
+        std::string message;
+        int64_t instructions;
+        int64_t cost;
+    };
+    const Options &options;
+    std::vector<Remark> remarks;
+    int muted = 0;
+    public:
+        static const int64_t unknown = -1;
+
+        Remarks(const Options &options) : options(options) {}
+        // czy warto budować komunikaty
+        bool enabled() const {
+            return muted == 0 && (!options.remarks_passed.empty() || !options.remarks_missed.empty());
+        }
+        void passed(const char *pass, int64_t line, const std::string &message,
+            int64_t instructions = unknown, int64_t cost = unknown);
+        void missed(const char *pass, int64_t line, const std::string &reason,
+            int64_t instructions = unknown, int64_t cost = unknown);
+
+        // uwagi z kodu generowanego na brudno (np. martwe przypisanie) pomijamy
+        class Mute {
+            Remarks &remarks;
+            public:
+                Mute(Remarks &remarks) : remarks(remarks) { remarks.muted++; }
+                ~Mute() { remarks.muted--; }
+        };
+
+        // ewaluacja częściowa generuje program drugi raz: zostają uwagi
+        // z tej generacji, której kod trafia do wyniku
+        size_t mark() const { return remarks.size(); }
+        void rollback(size_t mark) { remarks.resize(mark); }
+        void drop_before(size_t mark) { remarks.erase(remarks.begin(), remarks.begin() + mark); }
+
+        void write(std::ostream &out) const;
+        void clear() {
+            remarks.clear();
+            muted = 0;
+        }
+};
+#endif
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "serve.hpp"
+#include "compile.hpp"
+#include "protocol.hpp"
+
+// klient, który połączył się i nic nie wysyła (albo nie odbiera), zwalnia
+// wątek po tym czasie
+static const int timeout_seconds = 30;
+
+// ścieżka gniazda do usunięcia przy zakończeniu, także z obsługi sygnału
+static char socket_path[sizeof(sockaddr_un::sun_path)];
+
+static void stop(int signal) {
+    unlink(socket_path);
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+// połączenia czekające na wolny wątek
+struct Queue {
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<int> connections;
+
+    void push(int fd) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            connections.push_back(fd);
+        }
+        ready.notify_one();
+    }
+
+    int pop() {
+        std::unique_lock<std::mutex> guard(lock);
+        ready.wait(guard, [this] { return !connections.empty(); });
+        int fd = connections.front();
+        connections.pop_front();
+        return fd;
+    }
+};
+
+static void serve_connection(Context &ctx, std::ostringstream &log, const Options &defaults, int fd) {
+    std::vector<std::string> options;
+    std::vector<char> source;
+    if (!protocol::read_request(fd, options, source)) {
+        return;
+    }
+    ctx.reset();
+    log.str("");
+    log.clear();
+    ctx.options = defaults;
+    for (const std::string &option : options) {
+        if (!ctx.options.parse(option)) {
+            protocol::write_response(fd, 1, false, "", "", "Invalid option: " + option + "\n");
+            return;
+        }
+    }
+    std::ostringstream code, map;
+    bool written;
+    int status = compile(ctx, source, code, written, &map);
+    protocol::write_response(fd, status, written, code.str(), map.str(), log.str());
+}
+
+static void worker(Queue &queue, const Options &defaults) {
+    std::ostringstream log;
+    Context ctx(log);
+    while (true) {
+        int fd = queue.pop();
+        serve_connection(ctx, log, defaults, fd);
+        close(fd);
+    }
+}
+
+int run_server(const char *path, const Options &options) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return 1;
+    }
+    std::strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Cannot create socket: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    // gniazdo po poprzednim serwerze zostaje w systemie plików; usuwamy je
+    // tylko gdy nikt już na nim nie słucha
+    if (connect(listener, (sockaddr*)&address, sizeof(address)) == 0) {
+        std::cerr << "Server already running: " << path << std::endl;
+        close(listener);
+        return 1;
+    }
+    unlink(path);
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+        close(listener);
+        return 1;
+    }
+    std::strcpy(socket_path, path);
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+    std::signal(SIGHUP, stop);
+    // klient, który rozłączył się przed odpowiedzią, nie może zabić serwera
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // wątki żyją do końca procesu; kończy go sygnał albo błąd accept
+    Queue queue;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; i++) {
+        std::thread(worker, std::ref(queue), std::cref(options)).detach();
+    }
+    std::cerr << "Listening on " << path << " (" << threads << " threads)" << std::endl;
+    while (true) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            std::cerr << "Accept failed: " << std::strerror(errno) << std::endl;
+            close(listener);
+            unlink(path);
+            return 1;
+        }
+        timeval timeout = {timeout_seconds, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        queue.push(fd);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef SERVE_H
+#define SERVE_H 1
+
+#include "options.hpp"
+
+// Serwer kompilacji na gnieździe Unix (protokół w protocol.hpp). Każdy wątek
+// roboczy trzyma własny kontekst przez cały czas życia procesu; przed
+// kolejnym plikiem kontekst jest tylko czyszczony, więc areny, tablica nazw
+// i bufory zostają rozgrzane i kolejne kompilacje nie płacą za start procesu
+// ani za pierwsze alokacje. Opcje z linii poleceń serwera są domyślne, opcje
+// z zapytania są czytane na nie tym samym Options::parse. Działa do zabicia
+// procesu (SIGINT/SIGTERM usuwają plik gniazda).
+int run_server(const char *path, const Options &options);
+#endif
@@ -2,49 +2,68 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include <typeinfo>
 #include "ast.hpp"
 #include "symbols.hpp"
+#include "context.hpp"
 
-extern int errors;
-extern void yyerror(const char *msg);
-extern int yynerrs, yylineno;
 
+void error(Context &ctx, std::string msg, int64_t loc) {
+    ctx.log << "Error: near line " << loc << ": " << msg << std::endl;
+    ctx.errors++;
+}
+
+// wiąże identyfikator z numerem symbolu; ta sama nazwa dostaje ten sam numer,
+// a nazwy z puli Names porównujemy po wskaźniku
+int64_t Symbols::bind(ast::Identifier *identifier) {
+    auto found = ids.find(identifier->name);
+    if (found != ids.end()) {
+        return identifier->id = found->second;
+    }
+    int64_t id = table.size();
+    ids.emplace(identifier->name, id);
+    table.push_back(Symbol());
+    return identifier->id = id;
+}
 
-void error(std::string msg, int64_t loc) {
-    std::cerr << "Error: near line " << loc << ": " << msg << std::endl;
-    errors++;
+bool Symbols::exists(ast::Identifier *identifier) {
+    return get_symbol(identifier).line != Symbol::undef;
 }
 
-bool Symbols::declare(ast::Identifier *identifier) {
-    if(table.find(identifier->name) != table.end()){
+// reserve == false: symbol istnieje dla diagnostyki, ale nie zajmuje pamięci
+bool Symbols::declare(ast::Identifier *identifier, bool reserve) {
+    if(exists(identifier)){
         return false;
     }
     else {
         Symbol var;
         if (identifier->type() == 0) {
-            var = Symbol(identifier->name, identifier->line, offset);
+            var = Symbol(identifier->line, offset);
         } else if (identifier->type() == 1){
             ast::ConstArray* decl_array = ((ast::ConstArray*)identifier);
-            var = Symbol(identifier->name, identifier->line, (decl_array->index_e - decl_array->index_b)+3, offset,
+            var = Symbol(identifier->line, (decl_array->index_e - decl_array->index_b)+3, offset,
             decl_array->index_e, decl_array->index_b);
         }
-        offset += var.size;
+        if (reserve) {
+            offset += var.size;
+        } else {
+            var.offset_id = Symbol::undef;
+        }
         //std::cout << identifier->name <<  " " << var.offset_id << std::endl;
-        table[identifier->name] = var;
+        get_symbol(identifier) = var;
         return true;
     }
 }
 
 bool Symbols::declare_iterator(ast::Identifier *iterator) {
-    if(table.find(iterator->name) != table.end() && !table[iterator->name].not_in_scope){
+    Symbol &current = get_symbol(iterator);
+    if(exists(iterator) && !current.not_in_scope){
         return false;
     } else {
-        Symbol var;
-        var = Symbol(iterator->name, iterator->line, for_offset);
-        for_offset += var.size;
-        table[iterator->name] = var;
-        table[iterator->name].not_in_scope = false;
+        current = Symbol(iterator->line, for_offset);
+        for_offset += current.size;
+        current.not_in_scope = false;
         return true;
     }
 }
@@ -54,70 +73,81 @@ void Symbols::alloc_for_control(int64_t for_count) {
     offset += for_count*2;
 }
 
-Symbol Symbols::get_symbol(std::string name) {
-    if(table.find(name) != table.end()) {
-        return table[name];
+// Referencja jest ważna tylko do następnego bind(), który może powiększyć
+// tablicę; kto generuje kod dzieci (tam FOR wiąże swoje _TO_), kopiuje symbol
+// albo szuka go ponownie.
+Symbol &Symbols::get_symbol(ast::Identifier *identifier) {
+    if (identifier->id < 0 || identifier->id >= (int64_t)table.size()) {
+        throw std::logic_error(std::string("UNBOUND IDENTIFIER ") + identifier->name + ": LINE " + std::to_string(identifier->line));
     }
-    return Symbol();
+    return table[identifier->id];
 }
 
-bool Symbols::undeclare_iter(std::string name) {
-    if(table.find(name) == table.end()) {
+bool Symbols::undeclare_iter(ast::Identifier *identifier) {
+    if(!exists(identifier)) {
         return true;
     }
-    table[name].not_in_scope = true;
+    get_symbol(identifier).not_in_scope = true;
     return true;
 }
 
-bool Symbols::undeclare(std::string name) {
-        if(table.find(name) == table.end()) {
-        return true;
-    }
-    table.erase(name);
+bool Symbols::undeclare(ast::Identifier *identifier) {
+    get_symbol(identifier) = Symbol();
     return true;
 }
 
 bool Symbols::is_initialized(ast::Identifier *identifier) {
-    if(table.find(identifier->name) == table.end()) {
+    if(!exists(identifier)) {
         return false;
     }
-    if(table[identifier->name].not_in_scope == true){
+    if(get_symbol(identifier).not_in_scope == true){
         return false;
     } 
 
-    return table[identifier->name].is_initialized;
+    return get_symbol(identifier).is_initialized;
 }
 
 bool Symbols::set_initialized(ast::Identifier *identifier) {
-    if(table.find(identifier->name) == table.end()) {
+    if(!exists(identifier)) {
         return false;
     } else {
-        table[identifier->name].is_initialized = true;
+        get_symbol(identifier).is_initialized = true;
         return true;
     }
 }
 
 bool Symbols::is_iterator(ast::Identifier *identifier) {
-    if(table.find(identifier->name) == table.end()) {
+    if(!exists(identifier)) {
         return false;
     }
-    return table[identifier->name].iterator;
+    return get_symbol(identifier).iterator;
 }
 
 void Symbols::set_iterator(ast::Identifier *identifier) {
-    if(table.find(identifier->name) == table.end()) {
+    if(!exists(identifier)) {
         return;
     }
-    table[identifier->name].iterator = true;
+    get_symbol(identifier).iterator = true;
 }
 
 void Symbols::set_array(ast::Identifier *identifier) {
-    if(table.find(identifier->name) == table.end()) {
+    if(!exists(identifier)) {
         return;
     } else {
-        table[identifier->name].is_array = true;
+        get_symbol(identifier).is_array = true;
         // treat all arrays as initialized
-        table[identifier->name].is_initialized = true;
+        get_symbol(identifier).is_initialized = true;
     }
 }
 
+
+// zakresy komórek [początek, koniec) zajętych przez tablice wraz z nagłówkiem
+std::vector<std::pair<int64_t, int64_t>> Symbols::array_ranges() {
+    std::vector<std::pair<int64_t, int64_t>> ranges;
+    for (Symbol &var : table) {
+        if (var.line != Symbol::undef && var.is_array && var.offset_id != Symbol::undef) {
+            ranges.push_back(std::make_pair(var.offset_id, var.offset_id + var.size));
+        }
+    }
+    return ranges;
+}
\ No newline at end of file
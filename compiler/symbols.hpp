@@ -5,10 +5,13 @@
 #include <string>
 #include <sstream>
 #include <utility>
+#include <vector>
 #include <iostream>
 #include "ast.hpp"
 
-void error(std::string msg, int64_t loc);
+class Context;
+
+void error(Context &ctx, std::string msg, int64_t loc);
 
 class Symbol {
     public:
@@ -16,34 +19,41 @@ class Symbol {
         bool is_initialized = false;
         bool iterator = false;
         bool not_in_scope = false;
-        std::string name;
         int64_t offset_id;
         int64_t size, idx_a, idx_b;
         int64_t line;
         static const int64_t undef = -1;
         Symbol () : line(undef) {}
-        Symbol(std::string name, int64_t line, int64_t size, int64_t offset_id, int64_t idx_a, int64_t idx_b) : 
-        name(name), line(line), size(size), offset_id(offset_id), is_initialized(false), idx_a(idx_a), idx_b(idx_b) {}
-        Symbol(std::string name, int64_t line, int64_t offset_id) : 
-        name(name), line(line), size(1), offset_id(offset_id), is_initialized(false) {}
+        Symbol(int64_t line, int64_t size, int64_t offset_id, int64_t idx_a, int64_t idx_b) : 
+        line(line), size(size), offset_id(offset_id), is_initialized(false), idx_a(idx_a), idx_b(idx_b) {}
+        Symbol(int64_t line, int64_t offset_id) : 
+        line(line), size(1), offset_id(offset_id), is_initialized(false) {}
 };
 
 class Symbols {
     private:
         int64_t for_offset = 0;
-        std::unordered_map<std::string, Symbol> table;
+        // nazwa (wskaźnik z puli Names) -> gęsty numer symbolu
+        std::unordered_map<const char*, int64_t> ids;
+        // symbol niezadeklarowany ma line == Symbol::undef
+        std::vector<Symbol> table;
+        bool exists(ast::Identifier *identifier);
     public:
         int64_t offset = 1;
-        Symbol get_symbol(std::string);
-        bool declare(ast::Identifier *identifier);
+        int64_t bind(ast::Identifier *identifier);
+        // liczba związanych nazw, numery są z [0, size())
+        size_t size() const { return table.size(); }
+        Symbol &get_symbol(ast::Identifier *identifier);
+        bool declare(ast::Identifier *identifier, bool reserve = true);
         bool declare_iterator(ast::Identifier *iter);
-        bool undeclare(std::string name);
-        bool undeclare_iter(std::string name);
+        bool undeclare(ast::Identifier *identifier);
+        bool undeclare_iter(ast::Identifier *identifier);
         bool is_initialized(ast::Identifier *identifier);
         bool set_initialized(ast::Identifier *identifier);
         void alloc_for_control(int64_t for_count);
         bool is_iterator(ast::Identifier *identifier);
         void set_iterator(ast::Identifier *identifier);
         void set_array(ast::Identifier *identifier);
+        std::vector<std::pair<int64_t, int64_t>> array_ranges();
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <sys/resource.h>
+#include "timing.hpp"
+#include "context.hpp"
+
+// Zastępujemy globalne operator new/delete dla całego programu. Alokacje są
+// liczone w swoim wątku, ale dopiero gdy któryś kontekst włączył raport
+// czasów (pierwsze Timing::push); bez --time-report operator new płaci tylko
+// za odczyt jednej flagi przed malloc.
+static std::atomic<bool> counting(false);
+static thread_local int64_t heap_allocations = 0;
+
+void *operator new(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        heap_allocations++;
+    }
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+static const char *const phase_names[] = {
+    "parse", "declarations", "codegen", "optimize", "output"
+};
+
+static long peak_rss_kb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+int64_t Timing::allocations() {
+    return heap_allocations + ctx.nodes.allocations;
+}
+
+void Timing::charge() {
+    clock::time_point now = clock::now();
+    int64_t count = allocations();
+    if (!active.empty()) {
+        Total &total = totals[(int)active.back()];
+        total.ms += std::chrono::duration<double, std::milli>(now - mark).count();
+        total.allocations += count - mark_allocations;
+        total.peak_kb = peak_rss_kb();
+        total.used = true;
+    }
+    mark = now;
+    mark_allocations = count;
+}
+
+void Timing::reset() {
+    for (Total &total : totals) {
+        total = Total();
+    }
+    active.clear();
+}
+
+void Timing::push(Phase phase) {
+    if (ctx.options.time_report == Report::None) {
+        return;
+    }
+    counting.store(true, std::memory_order_relaxed);
+    charge();
+    active.push_back(phase);
+}
+
+void Timing::pop() {
+    if (ctx.options.time_report == Report::None) {
+        return;
+    }
+    charge();
+    active.pop_back();
+}
+
+void Timing::report(std::ostream &out) {
+    if (ctx.options.time_report == Report::None) {
+        return;
+    }
+    Total sum;
+    for (Total &total : totals) {
+        sum.ms += total.ms;
+        sum.allocations += total.allocations;
+        sum.peak_kb = std::max(sum.peak_kb, total.peak_kb);
+    }
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+    if (ctx.options.time_report == Report::Json) {
+        out << "{\"phases\": [";
+        bool first = true;
+        for (int i = 0; i < (int)Phase::count; i++) {
+            if (!totals[i].used) {
+                continue;
+            }
+            out << (first ? "" : ", ") << "{\"name\": \"" << phase_names[i] << "\", \"wall_ms\": " << totals[i].ms
+                << ", \"allocations\": " << totals[i].allocations << ", \"peak_rss_kb\": " << totals[i].peak_kb << "}";
+            first = false;
+        }
+        out << "], \"total\": {\"wall_ms\": " << sum.ms << ", \"allocations\": " << sum.allocations
+            << ", \"peak_rss_kb\": " << sum.peak_kb << "}, ";
+        ctx.passes.report(out, Report::Json);
+        out << "}" << std::endl;
+    } else {
+        out << "Time report:\n"
+            << std::left << std::setw(14) << "  phase" << std::right << std::setw(12) << "wall ms"
+            << std::setw(14) << "allocations" << std::setw(14) << "peak RSS KB" << "\n";
+        for (int i = 0; i < (int)Phase::count; i++) {
+            if (!totals[i].used) {
+                continue;
+            }
+            out << "  " << std::left << std::setw(12) << phase_names[i] << std::right << std::setw(12) << totals[i].ms
+                << std::setw(14) << totals[i].allocations << std::setw(14) << totals[i].peak_kb << "\n";
+        }
+        out << "  " << std::left << std::setw(12) << "total" << std::right << std::setw(12) << sum.ms
+            << std::setw(14) << sum.allocations << std::setw(14) << sum.peak_kb << "\n";
+        ctx.passes.report(out, Report::Text);
+        out << std::flush;
+    }
+    out.flags(flags);
+}
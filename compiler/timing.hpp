@@ -0,0 +1,53 @@
+#ifndef TIMING_H
+#define TIMING_H 1
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+class Context;
+
+enum class Phase { Parse, Declarations, Codegen, Optimize, Output, count };
+
+// Raport --time-report: czas, liczba alokacji i szczytowe RSS dla każdej
+// fazy kompilacji. Fazy się zagnieżdżają (deklaracje w Program::gen_ir,
+// ponowna generacja w ewaluacji częściowej), a czas i alokacje są liczone
+// tylko dla najbardziej wewnętrznej, więc suma wierszy to całość. Alokacje
+// to wywołania operator new w bieżącym wątku plus obiekty w arenie węzłów.
+// Szczytowe RSS jest wspólne dla procesu (w trybie wsadowym dla wszystkich
+// wątków). Włączany przez ctx.options; wyłączony kosztuje jedno porównanie
+// na zmianę fazy i odczyt flagi w każdym operator new (timing.cpp).
+class Timing {
+    typedef std::chrono::steady_clock clock;
+    struct Total {
+        double ms = 0;
+        int64_t allocations = 0;
+        long peak_kb = 0;
+        bool used = false;
+    };
+    Context &ctx;
+    Total totals[(int)Phase::count];
+    std::vector<Phase> active;
+    clock::time_point mark;
+    int64_t mark_allocations = 0;
+
+    int64_t allocations();
+    // dolicza czas i alokacje od ostatniej zmiany fazy do bieżącej
+    void charge();
+    public:
+        Timing(Context &ctx) : ctx(ctx) {}
+        void reset();
+        void push(Phase phase);
+        void pop();
+        void report(std::ostream &out);
+};
+
+// faza na czas życia obiektu
+class PhaseScope {
+    Timing &timing;
+    public:
+        PhaseScope(Timing &timing, Phase phase) : timing(timing) { timing.push(phase); }
+        ~PhaseScope() { timing.pop(); }
+};
+#endif
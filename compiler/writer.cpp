@@ -0,0 +1,165 @@
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include "writer.hpp"
+#include "object.hpp"
+#include "protocol.hpp"
+
+static const char digits[] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829"
+    "30313233343536373839" "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879" "80818283848586878889"
+    "90919293949596979899";
+
+// zapisuje liczbę od at, zwraca koniec
+static char *format_int(char *at, int64_t value) {
+    uint64_t rest = value;
+    if (value < 0) {
+        *at++ = '-';
+        rest = 0 - rest;
+    }
+    char text[20];
+    char *end = text + sizeof(text);
+    char *begin = end;
+    while (rest >= 100) {
+        unsigned pair = (rest % 100) * 2;
+        rest /= 100;
+        *--begin = digits[pair + 1];
+        *--begin = digits[pair];
+    }
+    if (rest >= 10) {
+        *--begin = digits[rest * 2 + 1];
+        *--begin = digits[rest * 2];
+    } else {
+        *--begin = '0' + rest;
+    }
+    std::memcpy(at, begin, end - begin);
+    return at + (end - begin);
+}
+
+char *AsmWriter::reserve(size_t size) {
+    if (capacity < size) {
+        capacity = size;
+        buffer.reset(new char[capacity]);
+    }
+    return buffer.get();
+}
+
+void AsmWriter::format(const std::vector<Instruction> &code) {
+    static const size_t longest = sizeof("STOREI -9223372036854775808\n");
+    const char *names[(int)ASM::HALT + 1];
+    size_t lengths[(int)ASM::HALT + 1];
+    for (int command = 0; command <= (int)ASM::HALT; command++) {
+        names[command] = asm_name((ASM)command);
+        lengths[command] = std::strlen(names[command]);
+    }
+    char *at = reserve(code.size() * longest);
+    for (const Instruction &instruction : code) {
+        size_t length = lengths[(int)instruction.command];
+        std::memcpy(at, names[(int)instruction.command], length);
+        at += length;
+        if (instruction.arg != Instruction::Undef) {
+            *at++ = ' ';
+            at = format_int(at, instruction.arg);
+        }
+        *at++ = '\n';
+    }
+    used = at - buffer.get();
+}
+
+void AsmWriter::format_object(const std::vector<Instruction> &code, bool lines) {
+    // argumenty spoza 23 bitów (i ujemne) trafiają do puli, każdy raz
+    std::vector<uint32_t> words;
+    words.reserve(code.size());
+    std::vector<int64_t> constants;
+    std::unordered_map<int64_t, uint32_t> pool;
+    for (const Instruction &instruction : code) {
+        uint32_t arg = object::no_arg;
+        if (instruction.arg != Instruction::Undef) {
+            if (instruction.arg >= 0 && instruction.arg < object::constant) {
+                arg = instruction.arg;
+            } else {
+                auto found = pool.find(instruction.arg);
+                if (found == pool.end()) {
+                    if (object::constant + constants.size() >= object::no_arg) {
+                        throw std::length_error("too many constants for the object format");
+                    }
+                    found = pool.emplace(instruction.arg, object::constant + constants.size()).first;
+                    constants.push_back(instruction.arg);
+                }
+                arg = found->second;
+            }
+        }
+        words.push_back((uint32_t)instruction.command << 24 | arg);
+    }
+
+    object::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, object::magic, sizeof(header.magic));
+    header.version = object::version;
+    header.byte_order = object::byte_order;
+    header.instructions = code.size();
+    header.constants = constants.size();
+    header.constants_offset = object::align(sizeof(header));
+    header.code_offset = header.constants_offset + constants.size() * sizeof(int64_t);
+    header.size = object::align(header.code_offset + words.size() * sizeof(uint32_t));
+    if (lines) {
+        header.flags |= object::has_lines;
+        header.lines_offset = header.size;
+        header.size += code.size() * sizeof(int64_t);
+    }
+
+    char *at = reserve(header.size);
+    std::memset(at, 0, header.size);
+    std::memcpy(at, &header, sizeof(header));
+    // pusta pula może mieć data() == NULL, a memcpy z NULL to UB nawet dla 0 bajtów
+    if (!constants.empty()) {
+        std::memcpy(at + header.constants_offset, constants.data(), constants.size() * sizeof(int64_t));
+    }
+    std::memcpy(at + header.code_offset, words.data(), words.size() * sizeof(uint32_t));
+    if (lines) {
+        int64_t *table = (int64_t*)(at + header.lines_offset);
+        for (size_t i = 0; i < code.size(); i++) {
+            table[i] = code[i].line;
+        }
+    }
+    used = header.size;
+}
+
+// nazwa konstrukcji po spacji
+static char *format_construct(char *at, Construct construct) {
+    const char *name = construct_name(construct);
+    size_t length = std::strlen(name);
+    *at++ = ' ';
+    std::memcpy(at, name, length);
+    return at + length;
+}
+
+void AsmWriter::format_lines(const std::vector<Instruction> &code, const std::vector<Site> &sites) {
+    static const size_t longest = sizeof("-9223372036854775808 -2147483648 Condition\n");
+    static const size_t longest_site = sizeof("site -2147483648 Condition -2147483648\n");
+    char *at = reserve(code.size() * longest + sites.size() * longest_site);
+    char *start = at;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (i == 0 || code[i].line != code[i - 1].line || code[i].construct != code[i - 1].construct) {
+            at = format_int(at, i);
+            *at++ = ' ';
+            at = format_int(at, code[i].line);
+            at = format_construct(at, code[i].construct);
+            *at++ = '\n';
+        }
+    }
+    for (const Site &site : sites) {
+        std::memcpy(at, "site ", 5);
+        at = format_int(at + 5, site.line);
+        at = format_construct(at, site.construct);
+        *at++ = ' ';
+        at = format_int(at, site.parent);
+        *at++ = '\n';
+    }
+    used = at - start;
+}
+
+bool AsmWriter::write_to(int fd) const {
+    return protocol::write_all(fd, buffer.get(), used);
+}
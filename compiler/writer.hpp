@@ -0,0 +1,35 @@
+#ifndef WRITER_H
+#define WRITER_H 1
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "asm.hpp"
+
+// Tekst całego programu składany w jednym buforze zamiast przez operator<<
+// dla każdego pola. Bufor jest alokowany raz na górne ograniczenie długości
+// (najdłuższa nazwa, spacja, 20 cyfr ze znakiem, koniec linii), liczby są
+// zamieniane na tekst po dwie cyfry z tablicy, a plik powstaje jednym
+// wywołaniem write(). Wynik jest identyczny z operator<<. format_object()
+// składa w tym samym buforze plik binarny (object.hpp), a format_lines()
+// mapę adresów na linie źródła (--line-map).
+class AsmWriter {
+    // bez zerowania, bo i tak jest cały nadpisywany
+    std::unique_ptr<char[]> buffer;
+    size_t capacity = 0;
+    size_t used = 0;
+
+    char *reserve(size_t size);
+    public:
+        void format(const std::vector<Instruction> &code);
+        // lines: z tablicą linii źródła
+        void format_object(const std::vector<Instruction> &code, bool lines = false);
+        // "adres linia konstrukcja" dla każdego rozkazu, od którego zmienia się
+        // linia albo konstrukcja, potem "site linia konstrukcja rodzic"
+        // dla instrukcji programu
+        void format_lines(const std::vector<Instruction> &code, const std::vector<Site> &sites);
+        const char *data() const { return buffer.get(); }
+        size_t size() const { return used; }
+        bool write_to(int fd) const;
+};
+#endif